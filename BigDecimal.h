@@ -1,167 +1,157 @@
+#ifndef BIGNUMERICS_BIGDECIMAL_H
+#define BIGNUMERICS_BIGDECIMAL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
+#include <stdexcept>
 #include <string>
-#include <sstream>
+#include <utility>
 #include <vector>
-#include <cmath>
-
-namespace BigNumerics {
-
-class BigDecimal {
 
-public:
-    BigDecimal(std::string n) {
-        if (n.size() > 0 && n[0] == '-') {
-            this->negative = true;
-            n.erase(0, 1);
-        }
-        else {
-            this->negative = false;
-        }
-        std::vector<std::string> nSplitted = split(n, '.');
+#include "BigInteger.h"
 
-        if (nSplitted.size() > 1) {
-            this->integral = std::vector<int>(nSplitted[0].size());
-            this->floatingPoint = std::vector<int>(nSplitted[1].size());
-
-            int sizeInt = this->integral.size();
-            for (int i = 0; i < sizeInt; i++) {
-                this->integral[i] = nSplitted[0][sizeInt - i - 1] - '0';
-            }
-
-            int sizeFP = this->floatingPoint.size();
-            for (int i = 0; i < sizeFP; i++) {
-                this->floatingPoint[i] = nSplitted[1][i] - '0';
-            }
+namespace BigNumerics {
 
-            removeIntegralLeadingZeroes(this->integral);
-            removeFloatingPointTrailingZeroes(this->floatingPoint);
-        }
-        else {
-            int sizeInt = n.size();
-            this->integral = std::vector<int>(sizeInt);
-            for (int i = 0; i < sizeInt; i++) {
-                this->integral[i] = nSplitted[0][sizeInt - i - 1] - '0';
-            }
+/*
+ * How BigDecimal rounds away the digits beyond a precision, as in Java. UP
+ * and DOWN round away from and toward zero, CEILING and FLOOR toward
+ * positive and negative infinity, the HALF_ modes to the nearest neighbour
+ * and break ties up, down or to the even neighbour. UNNECESSARY throws
+ * std::domain_error instead of dropping non zero digits.
+ */
+enum class RoundingMode {
+    UP,
+    DOWN,
+    CEILING,
+    FLOOR,
+    HALF_UP,
+    HALF_DOWN,
+    HALF_EVEN,
+    UNNECESSARY
+};
 
-            removeIntegralLeadingZeroes(this->integral);
-        }
-    }
+/*
+ * The number of significant digits an operation keeps and how it rounds
+ * the others. A precision of 0 asks for exact results.
+ */
+class MathContext {
 
-    BigDecimal() : integral{}, floatingPoint{}, negative{false} {}
+public:
+    explicit MathContext(std::uint64_t precision,
+                         RoundingMode roundingMode = RoundingMode::HALF_UP) :
+        digits{precision}, mode{roundingMode} {}
 
-    BigDecimal(std::vector<int> n) : integral{n}, negative{false} {
-        removeIntegralLeadingZeroes(this->integral);
+    std::uint64_t precision() const {
+        return this->digits;
     }
 
-    BigDecimal(std::vector<int> integral, std::vector<int> floatingPoint) :
-        integral{integral},
-        floatingPoint{floatingPoint}, negative{false} {
-        removeIntegralLeadingZeroes(this->integral);
-        removeFloatingPointTrailingZeroes(this->floatingPoint);
+    RoundingMode roundingMode() const {
+        return this->mode;
     }
 
-    ~BigDecimal() = default;
-
-    BigDecimal& operator+=(const BigDecimal& rhs) {
-
-        if ((this->negative && rhs.negative) ||
-            (this->negative && !rhs.negative) ||
-            (!this->negative && rhs.negative)) {
-            BigDecimal rightHandSide = rhs;
+private:
+    std::uint64_t digits;
+    RoundingMode mode;
+};
 
-            if (this->negative && !rhs.negative) {
-                std::swap(*this, rightHandSide);
-            }
+class BigDecimal {
 
-            rightHandSide.negative = false;
-            *this -= rightHandSide;
-            return *this;
+public:
+    /*
+     * A BigDecimal is unscaled 10^-scale, an arbitrary precision integer and
+     * a 64-bit scale as in Java, so that products and quotients run on the
+     * BigInteger kernels. Sums and comparisons first bring both operands to
+     * the larger scale, which only rescales one of them when the scales
+     * differ. Trailing zeroes are kept, 1.50 and 1.5 compare equal but hold
+     * different scales.
+     */
+    typedef BigInteger::Limb Limb;
+
+    BigDecimal(std::string n) : unscaled{}, fractionDigits{0} {
+        bool isNegative = false;
+        if (n.size() > 0 && (n[0] == '-' || n[0] == '+')) {
+            isNegative = n[0] == '-';
+            n.erase(0, 1);
         }
 
-        BigDecimal result;
-        result.negative = false;
+        size_t point = n.find('.');
+        std::string integralDigits = n.substr(0, point);
+        std::string floatingPointDigits = point == std::string::npos ?
+            std::string() : n.substr(point + 1);
 
-        int floatingPointSize = std::max(this->floatingPoint.size(),
-                                    rhs.floatingPoint.size());
+        parseDecimal(integralDigits, floatingPointDigits);
+        this->unscaled.limbs.setNegative(isNegative &&
+                                         !this->unscaled.limbs.empty());
+    }
 
-        result.floatingPoint = std::vector<int>(floatingPointSize);
+    BigDecimal() : unscaled{}, fractionDigits{0} {}
 
-        int minFloatingPointSize = std::min(this->floatingPoint.size(),
-                                       rhs.floatingPoint.size());
-        if (this->floatingPoint.size() != rhs.floatingPoint.size()) {
-            if (this->floatingPoint.size() == floatingPointSize) {
-                for (int i = floatingPointSize - 1; i >= minFloatingPointSize;
-                     i--) {
-                    result.floatingPoint[i] = this->floatingPoint[i];
-                }
-            }
-            else {
-                for (int i = floatingPointSize - 1; i >= minFloatingPointSize;
-                     i--) {
-                    result.floatingPoint[i] = rhs.floatingPoint[i];
-                }
-            }
+    /*
+     * Builds a BigDecimal from its integral decimal digits, least significant
+     * digit first.
+     */
+    BigDecimal(std::vector<int> n) : unscaled{}, fractionDigits{0} {
+        std::string integralDigits(n.size(), '0');
+        for (size_t i = 0; i < n.size(); i++) {
+            integralDigits[n.size() - i - 1] = (char)('0' + n[i]);
         }
+        parseDecimal(integralDigits, std::string());
+    }
 
-        bool carry = false;
+    /*
+     * Builds a BigDecimal from its integral digits, least significant digit
+     * first, and its floating point digits in the order they are written.
+     */
+    BigDecimal(std::vector<int> integral, std::vector<int> floatingPoint) :
+        unscaled{}, fractionDigits{0} {
+        std::string integralDigits(integral.size(), '0');
+        for (size_t i = 0; i < integral.size(); i++) {
+            integralDigits[integral.size() - i - 1] = (char)('0' + integral[i]);
+        }
 
-        for (int i = minFloatingPointSize - 1; i >= 0; i--) {
-            int r = this->floatingPoint[i] + rhs.floatingPoint[i] + carry;
-            if (r >= 10) {
-                carry = true;
-            }
-            else {
-                carry = false;
-            }
-            result.floatingPoint[i] = (r % 10);
+        std::string floatingPointDigits(floatingPoint.size(), '0');
+        for (size_t i = 0; i < floatingPoint.size(); i++) {
+            floatingPointDigits[i] = (char)('0' + floatingPoint[i]);
         }
 
-        int integralSize = std::max(this->integral.size(), rhs.integral.size());
+        parseDecimal(integralDigits, floatingPointDigits);
+    }
 
-        result.integral = std::vector<int>(integralSize);
+#ifdef BIGNUMERICS_HAS_MEMORY_RESOURCE
+    /*
+     * A zero whose limbs, and those of the results later assigned to it,
+     * come from the memory resource of allocator, a std::pmr arena for
+     * instance. Copies use the default resource like the std::pmr
+     * containers, see std::pmr::set_default_resource.
+     */
+    explicit BigDecimal(
+        const std::pmr::polymorphic_allocator<Limb>& allocator) :
+        unscaled{allocator}, fractionDigits{0} {}
+
+    BigDecimal(const BigDecimal& other,
+               const std::pmr::polymorphic_allocator<Limb>& allocator) :
+        unscaled{other.unscaled, allocator},
+        fractionDigits{other.fractionDigits} {}
+
+    std::pmr::memory_resource* memoryResource() const {
+        return this->unscaled.memoryResource();
+    }
+#endif
 
-        int minIntegralSize = std::min(this->integral.size(), rhs.integral.size());
+    BigDecimal(const BigDecimal& other) = default;
 
-        for (int i = 0; i < minIntegralSize; i++) {
-            int r = this->integral[i] + rhs.integral[i] + carry;
-            if (r >= 10) {
-                carry = true;
-            }
-            else {
-                carry = false;
-            }
-            result.integral[i] = (r % 10);
-        }
-
-        if (this->integral.size() != rhs.integral.size()) {
-            for (int i = minIntegralSize; i < integralSize; i++) {
-                int r = 0;
-                if (this->integral.size() == integralSize) {
-                    r = this->integral[i] + carry;
-                }
-                else {
-                    r = rhs.integral[i] + carry;
-                }
-
-                if (r >= 10) {
-                    carry = true;
-                }
-                else {
-                    carry = false;
-                }
-                result.integral[i] = (r % 10);
-            }
-        }
+    BigDecimal(BigDecimal&& other) = default;
 
-        if (carry) {
-            result.integral.push_back(1);
-        }
+    BigDecimal& operator=(const BigDecimal& other) = default;
 
-        *this = result;
+    BigDecimal& operator=(BigDecimal&& other) = default;
 
-        removeIntegralLeadingZeroes(this->integral);
-        removeFloatingPointTrailingZeroes(this->floatingPoint);
+    ~BigDecimal() = default;
 
+    BigDecimal& operator+=(const BigDecimal& rhs) {
+        add(rhs, false);
         return *this;
     }
 
@@ -171,562 +161,842 @@ public:
     }
 
     BigDecimal& operator-=(const BigDecimal& rhs) {
-        if (*this == rhs) {
-            *this = BigDecimal("0");
-            return *this;
-        }
+        add(rhs, true);
+        return *this;
+    }
 
-        BigDecimal result;
-        BigDecimal rightHandSide = rhs;
+    friend BigDecimal operator-(BigDecimal lhs, const BigDecimal& rhs) {
+        lhs -= rhs;
+        return lhs;
+    }
 
-        if (this->negative && !rightHandSide.negative) {
-            this->negative = false;
-            *this += rightHandSide;
-            this->negative = true;
-            return *this;
-        }
-        else if (!this->negative && rightHandSide.negative) {
-            rightHandSide.negative = false;
-            *this += rightHandSide;
-            this->negative = false;
-            return *this;
-        }
+    friend BigDecimal operator-(BigDecimal a) {
+        a.unscaled = -std::move(a.unscaled);
+        return a;
+    }
 
-        if (!this->negative && !rightHandSide.negative) {
-            if (*this < rightHandSide) {
-                std::swap(*this, rightHandSide);
-                result.negative = true;
-            }
-            else {
-                result.negative = false;
-            }
-        }
+    BigDecimal& operator*=(const BigDecimal& rhs) {
+        this->fractionDigits = scaleSum(this->fractionDigits,
+                                        rhs.fractionDigits);
+        this->unscaled *= rhs.unscaled;
+        return *this;
+    }
 
-        if (this->negative && rightHandSide.negative) {
-            if (*this > rightHandSide) {
-                std::swap(*this, rightHandSide);
-                result.negative = false;
-            }
-            else {
-                result.negative = true;
-            }
-        }
+    /*
+     * Products are evaluated lazily so that sums of products accumulate
+     * into their destination, see Expression.h. A product converts to a
+     * BigDecimal wherever one is expected and refers to its operands,
+     * which must outlive it.
+     */
+    friend expression::Product<BigDecimal> operator*(const BigDecimal& lhs,
+                                                     const BigDecimal& rhs) {
+        return expression::Product<BigDecimal>(lhs, rhs);
+    }
 
-        if (this->integral.size() != rightHandSide.integral.size()) {
-            int delta = 0;
-            if (this->integral.size() > rightHandSide.integral.size()) {
-                delta = this->integral.size() -
-                    rightHandSide.integral.size();
-                appendZeroes(rightHandSide.integral, delta);
-            }
-            else {
-                delta = rightHandSide.integral.size() -
-                    this->integral.size();
-                appendZeroes(this->integral, delta);
-            }
-        }
+    // A product with a temporary operand is evaluated at once, into it.
+    friend BigDecimal operator*(BigDecimal&& lhs, const BigDecimal& rhs) {
+        lhs *= rhs;
+        return std::move(lhs);
+    }
 
-        result.integral = std::vector<int>(this->integral.size());
+    friend BigDecimal operator*(const BigDecimal& lhs, BigDecimal&& rhs) {
+        rhs *= lhs;
+        return std::move(rhs);
+    }
 
-        int j = 0;
-        int k = 0;
+    friend BigDecimal operator*(BigDecimal&& lhs, BigDecimal&& rhs) {
+        lhs *= rhs;
+        return std::move(lhs);
+    }
 
-        while (j < this->integral.size()) {
-            int r = this->integral[j] - rightHandSide.integral[j];
-            result.integral[j] = positiveModulo(r + k, 10);
-            k = std::floor((r + k) / 10.0);
-            j++;
-        }
+    // this += a b, a and b may alias this.
+    BigDecimal& addmul(const BigDecimal& a, const BigDecimal& b) {
+        addProduct(a, b, false);
+        return *this;
+    }
 
-        if (this->floatingPoint.size() != rightHandSide.floatingPoint.size()) {
-            int delta = 0;
-            if (this->floatingPoint.size() > rightHandSide.floatingPoint.size()) {
-                delta = this->floatingPoint.size() -
-                    rightHandSide.floatingPoint.size();
-                appendZeroes(rightHandSide.floatingPoint, delta);
-            }
-            else {
-                delta = rightHandSide.floatingPoint.size() -
-                    this->floatingPoint.size();
-                appendZeroes(this->floatingPoint, delta);
-            }
+    // this -= a b, a and b may alias this.
+    BigDecimal& submul(const BigDecimal& a, const BigDecimal& b) {
+        addProduct(a, b, true);
+        return *this;
+    }
+
+    template <class E>
+    BigDecimal& operator=(const expression::Expression<BigDecimal, E>& e) {
+        if (expression::updateInPlace(*this, e)) {
+            return *this;
         }
 
-        result.floatingPoint = std::vector<int>(this->floatingPoint.size());
-        
-        if (!this->floatingPoint.empty() &&
-            !rightHandSide.floatingPoint.empty()) {
+        if (e.self().references(this)) {
+            *this = e.evaluate();
+            return *this;
+        }
 
-            j = this->floatingPoint.size() - 1;
-            k = 0;
+        // Reuses the limbs already allocated by this.
+        this->unscaled.limbs.clear();
+        this->unscaled.limbs.setNegative(false);
+        this->fractionDigits = 0;
+        e.self().accumulate(*this, false);
+        return *this;
+    }
 
-            // Always check that the floating point substraction is bigger - smaller
-            BigDecimal fpA({}, this->floatingPoint);
-            BigDecimal fpB({}, rightHandSide.floatingPoint);
+    template <class E>
+    BigDecimal& operator+=(const expression::Expression<BigDecimal, E>& e) {
+        expression::accumulate(*this, e, false);
+        return *this;
+    }
 
-            if (fpA < fpB) {
-                std::swap(fpA, fpB);
-            }
+    template <class E>
+    BigDecimal& operator-=(const expression::Expression<BigDecimal, E>& e) {
+        expression::accumulate(*this, e, true);
+        return *this;
+    }
 
-            while (j >= 0) {
-                int r = fpA.floatingPoint[j] - fpB.floatingPoint[j];
-                result.floatingPoint[j] = positiveModulo(r + k, 10);
-                k = std::floor((r + k) / 10.0);
-                j--;
-            }
+    /*
+     * Integer division, the quotient is truncated toward zero.
+     */
+    BigDecimal& operator/=(const BigDecimal& rhs) {
+        if (rhs.unscaled.limbs.empty()) {
+            throw std::domain_error("BigDecimal: division by zero");
         }
 
-        *this = result;
-        removeIntegralLeadingZeroes(this->integral);
-        removeFloatingPointTrailingZeroes(this->floatingPoint);
+        // u 10^-s / (v 10^-t) = u 10^(t - s) / v, the power of ten goes to
+        // whichever side keeps it an integer.
+        std::int64_t shift = scaleDifference(rhs.fractionDigits,
+                                             this->fractionDigits);
+        if (shift >= 0) {
+            this->unscaled.scaleByPowerOfTen(shift);
+            this->unscaled /= rhs.unscaled;
+        }
+        else {
+            BigInteger divisor = rhs.unscaled;
+            divisor.scaleByPowerOfTen(-shift);
+            this->unscaled /= divisor;
+        }
 
+        this->fractionDigits = 0;
         return *this;
     }
 
-    friend BigDecimal operator-(BigDecimal lhs, const BigDecimal& rhs) {
-        lhs -= rhs;
+    friend BigDecimal operator/(BigDecimal lhs, const BigDecimal& rhs) {
+        lhs /= rhs;
         return lhs;
     }
 
-    BigDecimal& operator*=(const BigDecimal& rhs) {
-        BigDecimal result;
+    /*
+     * a / b rounded to the precision of context. Only the requested digits
+     * are computed: the dividend is scaled so that the integer quotient has
+     * one digit to spare at most and the remainder decides the rounding,
+     * long quotients go through the Newton reciprocal of BigInteger's
+     * division. Precision 0 returns the exact quotient and throws
+     * std::domain_error when its expansion does not terminate.
+     */
+    friend BigDecimal divide(const BigDecimal& a, const BigDecimal& b,
+                             const MathContext& context) {
+        return divideRounded(a, b, context);
+    }
 
-        if (this->negative || rhs.negative) {
-            result.negative = true;
-        }
-        else {
-            result.negative = false;
+    // Rounds in place to the precision of context, see RoundingMode.
+    BigDecimal& round(const MathContext& context) {
+        if (context.precision() != 0) {
+            roundToPrecision(context, decimalDigits(this->unscaled), -1, true);
         }
+        return *this;
+    }
 
-        int m = this->integral.size();
-        int n = rhs.integral.size();
+    friend inline bool operator==(const BigDecimal& l, const BigDecimal& r) {
+        return compare(l, r) == 0;
+    }
 
-        result.integral = std::vector<int>(m + n);
+    friend inline bool operator!=(const BigDecimal& l, const BigDecimal& r) {
+        return !operator==(l, r);
+    }
 
-        int j = 0;
+    friend inline bool operator<(const BigDecimal& l, const BigDecimal& r) {
+        return compare(l, r) < 0;
+    }
 
-        while (j < n) {
-            if (rhs.integral[j] == 0) {
-                result.integral[j + m] = 0;
-            }
+    friend inline bool operator>(const BigDecimal& l, const BigDecimal& r) {
+        return operator<(r, l);
+    }
 
-            int i = 0;
-            int k = 0;
+    friend inline bool operator<=(const BigDecimal& l, const BigDecimal& r) {
+        return !operator>(l, r);
+    }
 
-            while (i < m) {
-                int t = this->integral[i] * rhs.integral[j]
-                    + result.integral[i + j] + k;
-                result.integral[i + j] = t % 10;
-                k = std::floor(t / 10.0);
-                i++;
-            }
+    friend inline bool operator>=(const BigDecimal& l, const BigDecimal& r) {
+        return !operator<(l, r);
+    }
 
-            result.integral[j + m] = k;
+    friend std::ostream& operator<<(std::ostream& os, const BigDecimal& bI) {
+        return os << bI.toString();
+    }
 
-            j++;
+    std::string toString() const {
+        if (this->unscaled.limbs.empty()) {
+            return "0";
         }
 
-        removeIntegralLeadingZeroes(result.integral);
+        std::string digits = detail::toDecimal(this->unscaled.limbs.data(),
+                                               this->unscaled.limbs.size());
+        std::string s = this->unscaled.limbs.negative() ? "-" : "";
 
-        m = this->floatingPoint.size();
-        n = rhs.floatingPoint.size();
+        if (this->fractionDigits <= 0) {
+            s += digits;
+            s.append((size_t)-(this->fractionDigits), '0');
+            return s;
+        }
 
-        result.floatingPoint = std::vector<int>(m + n);
+        size_t fraction = (size_t)this->fractionDigits;
+        if (digits.size() <= fraction) {
+            s += "0.";
+            s.append(fraction - digits.size(), '0');
+            s += digits;
+        }
+        else {
+            s.append(digits, 0, digits.size() - fraction);
+            s.push_back('.');
+            s.append(digits, digits.size() - fraction, fraction);
+        }
 
-        j = 0;
+        s.erase(s.find_last_not_of('0') + 1);
+        if (s.back() == '.') {
+            s.pop_back();
+        }
+        return s;
+    }
 
-        while (j < n) {
-            if (rhs.floatingPoint[j] == 0) {
-                result.floatingPoint[j + m] = 0;
-            }
+    // unscaled 10^-scale, as in Java.
+    static BigDecimal valueOf(BigInteger unscaled, std::int64_t scale) {
+        BigDecimal r;
+        r.unscaled = std::move(unscaled);
+        r.fractionDigits = scale;
+        return r;
+    }
 
-            int i = 0;
-            int k = 0;
+    // Shared constants, built once on first use.
+    static const BigDecimal& zero() {
+        static const BigDecimal value;
+        return value;
+    }
 
-            while (i < m) {
-                int t = this->floatingPoint[i] * rhs.floatingPoint[j]
-                    + result.floatingPoint[i + j] + k;
-                result.floatingPoint[i + j] = t % 10;
-                k = std::floor(t / 10.0);
-                i++;
-            }
+    static const BigDecimal& one() {
+        static const BigDecimal value = valueOf(BigInteger::one(), 0);
+        return value;
+    }
 
-            result.floatingPoint[j + m] = k;
+    static const BigDecimal& ten() {
+        static const BigDecimal value = valueOf(BigInteger::ten(), 0);
+        return value;
+    }
 
-            j++;
-        }
-        std::reverse(result.floatingPoint.begin(), result.floatingPoint.end());
+    // The value is unscaledValue() 10^-scale().
+    const BigInteger& unscaledValue() const {
+        return this->unscaled;
+    }
 
-        removeFloatingPointLeadingZeroes(result.floatingPoint);
-        removeFloatingPointTrailingZeroes(result.floatingPoint);
+    std::int64_t scale() const {
+        return this->fractionDigits;
+    }
 
-        if (m + n - result.floatingPoint.size() != 0) {
-            std::vector<int> newFloatingPoint(m + n);
-            std::copy(result.floatingPoint.begin(), result.floatingPoint.end(),
-                      newFloatingPoint.begin() + (m + n -
-                      result.floatingPoint.size()));
-            result.floatingPoint = newFloatingPoint;
-        }
+    // Bytes taken by the record of serialize().
+    std::size_t serializedSize() const {
+        return this->unscaled.serializedSize() + 8;
+    }
 
-        *this = result;
-        return *this;
+    /*
+     * Appends the binary record of this to out: the record of
+     * BigInteger::serialize() with the decimal flag set and the scale after
+     * the limb count. Trailing zeroes are kept.
+     */
+    void serialize(std::vector<unsigned char>& out) const {
+        const detail::LimbVector& limbs = this->unscaled.limbs;
+        detail::serializeRecord(out, limbs.data(), limbs.size(),
+                                limbs.negative(), true, this->fractionDigits);
     }
 
-    friend BigDecimal operator*(BigDecimal lhs, BigDecimal rhs) {
-        lhs *= rhs;
-        return lhs;
+    /*
+     * Reads the record at the start of the size bytes of data, see
+     * BigInteger::deserialize().
+     */
+    static BigDecimal deserialize(const unsigned char* data,
+                                  std::size_t size) {
+        detail::SerialRecord record = detail::readSerialRecord(data, size,
+                                                               "BigDecimal");
+        if (!record.decimal) {
+            throw std::invalid_argument(
+                "BigDecimal: the record holds a BigInteger");
+        }
+
+        BigDecimal r;
+        detail::LimbVector& limbs = r.unscaled.limbs;
+        limbs.resize(record.n);
+        detail::loadLimbs(limbs.data(), record.limbs, record.n);
+        limbs.setNegative(record.negative);
+        r.fractionDigits = record.scale;
+        return r;
     }
 
-    BigDecimal& operator/=(const BigDecimal& rhs) {
-        if (rhs == BigDecimal("0")) {
-            *this = BigDecimal("nan");
-            return *this;
-        }
+    /*
+     * Multiplies by 10^k in place, k may be negative. Only the scale
+     * changes, so scaling takes constant time whatever k is.
+     */
+    BigDecimal& scaleByPowerOfTen(long long k) {
+        this->fractionDigits = scaleDifference(this->fractionDigits,
+                                               (std::int64_t)k);
+        return *this;
+    }
 
-        if (rhs > *this) {
-            *this = BigDecimal("0");
-            return *this;
-        }
+    // Divides by 10^k in place, see scaleByPowerOfTen().
+    BigDecimal& movePointLeft(long long k) {
+        return scaleByPowerOfTen(-k);
+    }
 
-        if (this->negative || rhs.negative) {
-            this->negative = true;
-        }
-        else {
-            this->negative = false;
-        }
+    // Multiplies by 10^k in place, see scaleByPowerOfTen().
+    BigDecimal& movePointRight(long long k) {
+        return scaleByPowerOfTen(k);
+    }
 
-        if (rhs == *this) {
-            *this = BigDecimal("1");
-            return *this;
+    static BigDecimal& floor(BigDecimal& a) {
+        bool isNegative = a.unscaled.limbs.negative();
+        if (truncate(a) && isNegative) {
+            a.unscaled -= 1;
         }
+        return a;
+    }
 
-        BigDecimal u = *this;
-        BigDecimal v = rhs;
-
-        unsigned long long int m = u.integral.size() - v.integral.size();
-        unsigned long long int n = v.integral.size();
+    static BigDecimal& ceil(BigDecimal& a) {
+        bool isNegative = a.unscaled.limbs.negative();
+        if (truncate(a) && !isNegative) {
+            a.unscaled += 1;
+        }
+        return a;
+    }
 
-        BigDecimal q;
-        q.integral = std::vector<int>(m+1);
+private:
+    BigInteger unscaled;
+    // Digits after the decimal point, negative for trailing integral zeroes.
+    std::int64_t fractionDigits;
 
-        if ((!u.negative && v.negative) || (u.negative && !v.negative)) {
-            q.negative = true;
-        }
+    void parseDecimal(const std::string& integralDigits,
+                      const std::string& floatingPointDigits) {
+        checkDigits(integralDigits);
+        checkDigits(floatingPointDigits);
 
-        if (n == 1) {
-            long long int j = u.integral.size() - 1;
-            int r = 0;
+        this->unscaled = BigInteger(integralDigits + floatingPointDigits);
+        this->fractionDigits = (std::int64_t)floatingPointDigits.size();
+    }
 
-            while (j >= 0) {
-                int w_j = std::floor(( r * 10 + u.integral[j]) / v.integral[0]);
-                r = ( r * 10 + u.integral[j]) % v.integral[0];
-                q.integral[j] = w_j;
-                j--;
+    static void checkDigits(const std::string& digits) {
+        for (size_t i = 0; i < digits.size(); i++) {
+            if (digits[i] < '0' || digits[i] > '9') {
+                throw std::invalid_argument("BigDecimal: invalid digit in \"" +
+                                            digits + "\"");
             }
+        }
+    }
 
-            removeIntegralLeadingZeroes(q.integral);
+    static std::int64_t scaleSum(std::int64_t a, std::int64_t b) {
+        std::int64_t sum;
+        if (__builtin_add_overflow(a, b, &sum)) {
+            throw std::overflow_error("BigDecimal: scale overflow");
+        }
+        return sum;
+    }
 
-            *this = q;
-            return *this;
+    static std::int64_t scaleDifference(std::int64_t a, std::int64_t b) {
+        std::int64_t difference;
+        if (__builtin_sub_overflow(a, b, &difference)) {
+            throw std::overflow_error("BigDecimal: scale overflow");
         }
+        return difference;
+    }
 
-        // D1
-        int d = std::floor(10.0 / (rhs.integral[rhs.integral.size() - 1] + 1));
-        BigDecimal D(std::to_string(d));
-
-        u *= D;
-        u.integral.push_back(0);
-        v *= D;
-
-        // D2
-        long long int j = m;
-
-        while (j >= 0) {
-            // D3
-            int q_hat = std::floor((u.integral[j + n] * 10.0 +
-                        u.integral[j + n - 1]) / (double)v.integral[n - 1]);
-
-            int r_hat = (u.integral[j + n] * 10 + u.integral[j + n - 1]) %
-                v.integral[n - 1];
-
-            if ((q_hat >= 10) || (q_hat * v.integral[n - 2] >
-                10 * r_hat + u.integral[j + n - 2])) {
-                q_hat--;
-                r_hat += v.integral[n-1];
-
-                while (r_hat < 10) {
-                    if ((q_hat >= 10) || (q_hat * v.integral[n - 2] >
-                        10 * r_hat + u.integral[j + n - 2])) {
-                        q_hat--;
-                        r_hat += v.integral[n-1];
-                    }
-                    else {
-                        break;
-                    }
-                }
-            }
+    // An empty integer on the memory resource of this, for intermediates.
+    BigInteger scratchInteger() const {
+        return BigInteger(
+            detail::LimbVector(this->unscaled.limbs.memoryResource()));
+    }
 
-            // D4
-            std::vector<int> a(u.integral.begin() + j, u.integral.begin() + j + n + 1);
-            BigDecimal tempU(a);
-            tempU -= BigDecimal(std::to_string(q_hat)) * v;
-
-            bool resultOfStepD4Negative = tempU.negative;
-            if (resultOfStepD4Negative) {
-                BigDecimal complement("10");
-                for (long long int i = 0; i < n+1; i++) {
-                    complement *= BigDecimal("10");
-                }
-                tempU += complement;
-            }
+    // Brings this to a larger scale, keeping its value.
+    void rescale(std::int64_t larger) {
+        this->unscaled.scaleByPowerOfTen(scaleDifference(larger,
+                                                         this->fractionDigits));
+        this->fractionDigits = larger;
+    }
 
-            while (tempU.integral.size() < n+1) {
-                tempU.integral.push_back(0);
+    // this += b or this -= b.
+    void add(const BigDecimal& b, bool subtract) {
+        if (this == &b) {
+            if (subtract) {
+                this->unscaled.limbs.clear();
+                this->unscaled.limbs.setNegative(false);
             }
-
-            for (long long int i = j; i <= j + n; i++) {
-                u.integral[i] = tempU.integral[i-j];
+            else {
+                this->unscaled += this->unscaled;
             }
+            return;
+        }
 
-            // D5
-            unsigned long long int q_j = q_hat;
-
-            if (resultOfStepD4Negative) {
-                // D6
-                q_j--;
-
-                std::vector<int> uJtoJN(n+1);
-                std::copy(u.integral.begin() + j,
-                          u.integral.begin() + j + n + 1,
-                          uJtoJN.begin());
-                tempU = BigDecimal(uJtoJN);
-                tempU += v;
-
-                std::copy(tempU.integral.begin(), tempU.integral.begin() + n,
-                          u.integral.begin() + j);
-            }
+        if (b.unscaled.limbs.empty()) {
+            return;
+        }
 
-            q.integral[j] = q_j;
+        if (this->unscaled.limbs.empty()) {
+            this->unscaled = b.unscaled;
+            this->unscaled.limbs.setNegative(b.unscaled.limbs.negative() !=
+                                             subtract);
+            this->fractionDigits = b.fractionDigits;
+            return;
+        }
 
-            // D7
-            j--;
+        if (this->fractionDigits > b.fractionDigits) {
+            BigInteger aligned = scratchInteger();
+            aligned = b.unscaled;
+            aligned.scaleByPowerOfTen(scaleDifference(this->fractionDigits,
+                                                      b.fractionDigits));
+            addInteger(aligned, subtract);
+            return;
         }
 
-        removeIntegralLeadingZeroes(q.integral);
-        
-        // D8
-        *this = q;
-        return *this;
+        if (this->fractionDigits < b.fractionDigits) {
+            rescale(b.fractionDigits);
+        }
+        addInteger(b.unscaled, subtract);
     }
 
-    friend BigDecimal operator/(BigDecimal lhs, BigDecimal rhs) {
-        lhs /= rhs;
-        return lhs;
+    void addInteger(const BigInteger& b, bool subtract) {
+        if (subtract) {
+            this->unscaled -= b;
+        }
+        else {
+            this->unscaled += b;
+        }
     }
 
-    friend inline bool operator==(const BigDecimal& l, const BigDecimal& r) {
-        if (l.integral.size() != r.integral.size() ||
-            l.floatingPoint.size() != r.floatingPoint.size()) {
-            return false;
+    void addProduct(const BigDecimal& a, const BigDecimal& b, bool subtract) {
+        if (a.unscaled.limbs.empty() || b.unscaled.limbs.empty()) {
+            return;
         }
 
-        for (size_t i = 0; i < l.integral.size(); i++) {
-            if (l.integral[i] != r.integral[i]) {
-                return false;
-            }
+        std::int64_t productScale = scaleSum(a.fractionDigits,
+                                             b.fractionDigits);
+        bool aliased = this == &a || this == &b;
+
+        if (this->unscaled.limbs.empty()) {
+            this->fractionDigits = productScale;
+        }
+        else if (this->fractionDigits < productScale && !aliased) {
+            rescale(productScale);
         }
 
-        for (size_t i = 0; i < l.floatingPoint.size(); i++) {
-            if (l.floatingPoint[i] != r.floatingPoint[i]) {
-                return false;
+        if (this->fractionDigits == productScale) {
+            if (subtract) {
+                this->unscaled.submul(a.unscaled, b.unscaled);
             }
+            else {
+                this->unscaled.addmul(a.unscaled, b.unscaled);
+            }
+            return;
         }
 
-        return true;
+        BigInteger product = scratchInteger();
+        product.addmul(a.unscaled, b.unscaled);
+        if (this->fractionDigits > productScale) {
+            product.scaleByPowerOfTen(scaleDifference(this->fractionDigits,
+                                                      productScale));
+        }
+        else {
+            rescale(productScale);
+        }
+        addInteger(product, subtract);
     }
 
-    friend inline bool operator!=(const BigDecimal& l, const BigDecimal& r) {
-        return !operator==(l, r);
+    static int sign(const BigDecimal& a) {
+        if (a.unscaled.limbs.empty()) {
+            return 0;
+        }
+        return a.unscaled.limbs.negative() ? -1 : 1;
     }
 
-    friend inline bool operator<(const BigDecimal& l, const BigDecimal& r) {
-        if ((l.negative && !r.negative) ||
-            (l.integral.size() < r.integral.size())) {
-            return true;
+    static BigDecimal divideRounded(const BigDecimal& a, const BigDecimal& b,
+                                    const MathContext& context) {
+        if (b.unscaled.limbs.empty()) {
+            throw std::domain_error("BigDecimal: division by zero");
         }
-        if ((!l.negative && r.negative) ||
-            (l.integral.size() > r.integral.size())) {
-            return false;
+        if (a.unscaled.limbs.empty()) {
+            return BigDecimal();
         }
-
-        for (int i = (int)l.integral.size() - 1; i >= 0; i--) {
-            if (l.integral[i] < r.integral[i]) {
-                if (!l.negative && !r.negative) {
-                    return true;
-                }
-                else {
-                    return false;
-                }
-            }
-            else if (l.integral[i] > r.integral[i]){
-                if (!l.negative && !r.negative) {
-                    return false;
-                }
-                else {
-                    return true;
-                }
-            }
+        if (context.precision() == 0) {
+            return divideExactly(a, b);
         }
 
-        for (int i = 0; i < (int)std::min(l.floatingPoint.size(),
-                                          r.floatingPoint.size()); i++) {
-            if (l.floatingPoint[i] < r.floatingPoint[i]) {
-                if (!l.negative && !r.negative) {
-                    return true;
-                }
-                else {
-                    return false;
-                }
-            }
-            else if (l.floatingPoint[i] > r.floatingPoint[i]){
-                if (!l.negative && !r.negative) {
-                    return false;
-                }
-                else {
-                    return true;
-                }
-            }
-        }
+        // a 10^s / b has precision or precision + 1 digits, the latter when
+        // the leading digits of a are at least those of b. Comparing them at
+        // the length of the operands avoids counting the quotient digits.
+        std::int64_t precision = (std::int64_t)context.precision();
+        std::int64_t aDigits = decimalDigits(a.unscaled);
+        std::int64_t bDigits = decimalDigits(b.unscaled);
+        std::int64_t shift = scaleSum(scaleDifference(precision, aDigits),
+                                      bDigits);
 
-        return false;
-    }
-
-    friend inline bool operator>(const BigDecimal& l, const BigDecimal& r) {
-        return operator<(r, l);
-    }
+        BigInteger dividend = a.unscaled;
+        BigInteger divisor = b.unscaled;
+        dividend.limbs.setNegative(false);
+        divisor.limbs.setNegative(false);
 
-    friend inline bool operator<=(const BigDecimal& l, const BigDecimal& r) {
-        return !operator>(l, r);
-    }
+        BigInteger aligned = aDigits < bDigits ? dividend : divisor;
+        aligned.scaleByPowerOfTen(aDigits < bDigits ? bDigits - aDigits :
+                                  aDigits - bDigits);
+        bool longer = aDigits < bDigits ?
+            compareIntegers(aligned, divisor) >= 0 :
+            compareIntegers(dividend, aligned) >= 0;
 
-    friend inline bool operator>=(const BigDecimal& l, const BigDecimal& r) {
-        return !operator<(l, r);
+        if (shift >= 0) {
+            dividend.scaleByPowerOfTen(shift);
+        }
+        else {
+            divisor.scaleByPowerOfTen(-shift);
+        }
+
+        BigDecimal quotient;
+        BigInteger remainder;
+        BigInteger::divmod(dividend, divisor, quotient.unscaled, remainder);
+        quotient.unscaled.limbs.setNegative(a.unscaled.limbs.negative() !=
+                                            b.unscaled.limbs.negative());
+        quotient.fractionDigits = scaleSum(
+            scaleDifference(a.fractionDigits, b.fractionDigits), shift);
+
+        BigInteger twice = remainder;
+        twice += remainder;
+        quotient.roundToPrecision(context, longer ? precision + 1 : precision,
+                                  compareIntegers(twice, divisor),
+                                  remainder.limbs.empty());
+        return quotient;
     }
 
-    friend std::ostream& operator<<(std::ostream& os, const BigDecimal& bI) {
-        if (bI.negative) {
-            os << '-';
+    /*
+     * The number of decimal digits of |a| lies in [lower, upper], upper is
+     * lower or lower + 1. Only takes the bit length of a.
+     */
+    static void decimalDigitBounds(const BigInteger& a, std::int64_t& lower,
+                                   std::int64_t& upper) {
+        std::size_t bits = BigInteger::bitLength(a);
+        if (bits == 0) {
+            lower = upper = 0;
+            return;
         }
 
-        for (int i = bI.integral.size() - 1; i >= 0; i--) {
-            os << bI.integral[i];
-        }
+        // 2^(bits - 1) <= |a| < 2^bits leaves two candidates at most.
+        const double log10Of2 = 0.30102999566398119521;
+        lower = (std::int64_t)((double)(bits - 1) * log10Of2) + 1;
+        upper = (std::int64_t)((double)bits * log10Of2) + 1;
+    }
 
-        if (bI.integral.size() == 0) {
-            os << '0';
-        }
-        if (bI.floatingPoint.size() > 0) {
-            os << '.';
-            for (int i = 0; i < bI.floatingPoint.size(); i++) {
-                os << bI.floatingPoint[i];
-            }
+    // Number of decimal digits of |a|, 0 for a = 0.
+    static std::int64_t decimalDigits(const BigInteger& a) {
+        std::int64_t lower;
+        std::int64_t upper;
+        decimalDigitBounds(a, lower, upper);
+        if (lower == upper) {
+            return lower;
         }
-        return os;
-    }
 
-    static BigDecimal& floor(BigDecimal& a) {
-        a.floatingPoint = std::vector<int>();
-        return a;
+        BigInteger power = pow(BigInteger::ten(), (unsigned long long)lower);
+        return BigInteger::compareMagnitudes(a, power) >= 0 ? upper : lower;
     }
 
-    static BigDecimal& ceil(BigDecimal& a) {
-        a.floatingPoint = std::vector<int>();
-        return a;
+    // Number of trailing zero bits of a non zero a.
+    static std::size_t trailingZeroBits(const BigInteger& a) {
+        std::size_t i = 0;
+        while (a.limbs[i] == 0) {
+            i++;
+        }
+        return i * detail::LIMB_BITS + (std::size_t)__builtin_ctzll(a.limbs[i]);
     }
 
-private:
-    std::vector<int> integral;
-    std::vector<int> floatingPoint;
-    bool negative;
+    /*
+     * Whether rounding a magnitude ending in an odd or even digit moves it
+     * away from zero. half compares the dropped part with half a unit in
+     * the last kept digit, zero tells whether the dropped part is zero.
+     */
+    static bool roundsAway(RoundingMode mode, bool negative, bool odd,
+                           int half, bool zero) {
+        switch (mode) {
+        case RoundingMode::UP:
+            return !zero;
+        case RoundingMode::DOWN:
+            return false;
+        case RoundingMode::CEILING:
+            return !zero && !negative;
+        case RoundingMode::FLOOR:
+            return !zero && negative;
+        case RoundingMode::HALF_UP:
+            return half >= 0 && !zero;
+        case RoundingMode::HALF_DOWN:
+            return half > 0;
+        case RoundingMode::HALF_EVEN:
+            return half > 0 || (half == 0 && odd);
+        case RoundingMode::UNNECESSARY:
+            if (!zero) {
+                throw std::domain_error("BigDecimal: rounding necessary");
+            }
+            return false;
+        }
+        return false;
+    }
 
-    static void removeIntegralLeadingZeroes(std::vector<int>& v) {
-        if (v.empty()) {
+    /*
+     * Rounds to the precision of context, digits is decimalDigits() of the
+     * unscaled value. this may already be the truncation of a longer value,
+     * tailHalf and tailZero then describe the part dropped from it as in
+     * roundsAway().
+     */
+    void roundToPrecision(const MathContext& context, std::int64_t digits,
+                          int tailHalf, bool tailZero) {
+        std::int64_t precision = (std::int64_t)context.precision();
+        if (digits <= precision && tailZero) {
             return;
         }
 
-        auto nonZeroIndex = 0;
-        for (int i = v.size() - 1; i >= 0; i--) {
-            if (v[i] != 0) {
-                nonZeroIndex = i;
+        bool isNegative = this->unscaled.limbs.negative();
+        BigInteger kept = this->unscaled;
+        kept.limbs.setNegative(false);
+        std::int64_t dropped = 0;
+        int half = tailHalf;
+        bool zero = tailZero;
+
+        if (digits > precision) {
+            dropped = digits - precision;
+            BigInteger power = pow(BigInteger::ten(),
+                                   (unsigned long long)dropped);
+            BigInteger remainder;
+            BigInteger::divmod(this->unscaled, power, kept, remainder);
+            kept.limbs.setNegative(false);
+            remainder.limbs.setNegative(false);
+
+            // The tail below the dropped digits only matters for a tie.
+            BigInteger twice = remainder;
+            twice += remainder;
+            int c = compareIntegers(twice, power);
+            half = c != 0 ? c : tailZero ? 0 : 1;
+            zero = zero && remainder.limbs.empty();
+        }
+
+        bool odd = !kept.limbs.empty() && (kept.limbs[0] & 1) != 0;
+        if (roundsAway(context.roundingMode(), isNegative, odd, half, zero)) {
+            // kept had at most precision digits, it only grows longer when
+            // it reaches 10^precision, which ends in precision zero bits.
+            kept += 1;
+            if (digits - dropped == precision &&
+                trailingZeroBits(kept) >= (std::size_t)precision &&
+                decimalDigits(kept) > precision) {
+                kept.scaleByPowerOfTen(-1);
+                dropped++;
+            }
+        }
+
+        kept.limbs.setNegative(isNegative && !kept.limbs.empty());
+        this->unscaled = std::move(kept);
+        this->fractionDigits = scaleDifference(this->fractionDigits, dropped);
+    }
+
+    /*
+     * a / b exactly. The quotient terminates when b / gcd(a, b) = 2^i 5^j,
+     * it is then a / gcd(a, b) 2^(k - i) 5^(k - j) 10^-k with k = max(i, j).
+     */
+    static BigDecimal divideExactly(const BigDecimal& a, const BigDecimal& b) {
+        BigInteger divisor = gcd(a.unscaled, b.unscaled);
+        BigDecimal quotient;
+        quotient.unscaled = a.unscaled / divisor;
+        BigInteger rest = b.unscaled / divisor;
+        rest.limbs.setNegative(false);
+
+        std::size_t twos = trailingZeroBits(rest);
+        rest = BigInteger::shiftedRight(rest, twos);
+
+        std::size_t fives = 0;
+        const BigInteger& five = BigInteger::five();
+        BigInteger q;
+        BigInteger r;
+        for (;;) {
+            BigInteger::divmod(rest, five, q, r);
+            if (!r.limbs.empty()) {
                 break;
             }
+            rest = std::move(q);
+            fives++;
         }
 
-        v.erase(v.begin() + nonZeroIndex + 1, v.end());
-    }
-
-    static void removeFloatingPointTrailingZeroes(std::vector<int>& v) {
-        if (v.empty()) {
-            return;
+        if (rest != BigInteger::one()) {
+            throw std::domain_error(
+                "BigDecimal: non-terminating decimal expansion");
         }
 
-        auto nonZeroIndex = 0;
-        for (auto i = v.size() - 1; i >= 0; i--) {
-            if (v[i] != 0) {
-                nonZeroIndex = i;
-                break;
-            }
+        std::size_t k = std::max(twos, fives);
+        bool isNegative = quotient.unscaled.limbs.negative() !=
+            b.unscaled.limbs.negative();
+        quotient.unscaled = BigInteger::shiftedLeft(quotient.unscaled,
+                                                    k - twos);
+        if (k > fives) {
+            quotient.unscaled *= pow(five, (unsigned long long)(k - fives));
         }
+        quotient.unscaled.limbs.setNegative(isNegative);
+        quotient.fractionDigits = scaleSum(
+            scaleDifference(a.fractionDigits, b.fractionDigits),
+            (std::int64_t)k);
+        return quotient;
+    }
 
-        v.erase(v.begin() + nonZeroIndex + 1, v.end());
+    static int compareIntegers(const BigInteger& l, const BigInteger& r) {
+        return l < r ? -1 : l == r ? 0 : 1;
     }
 
-    static void removeFloatingPointLeadingZeroes(std::vector<int>& v) {
-        if (v.empty()) {
-            return;
-        }
+    static int compare(const BigDecimal& l, const BigDecimal& r) {
+        if (l.fractionDigits == r.fractionDigits) {
+            return compareIntegers(l.unscaled, r.unscaled);
+        }
+
+        int lSign = sign(l);
+        int rSign = sign(r);
+        if (lSign != rSign || lSign == 0) {
+            return lSign < rSign ? -1 : lSign > rSign ? 1 : 0;
+        }
+
+        // A non zero x lies in [10^(e - 1), 10^e) for its adjusted exponent
+        // e = digits - scale, as in Java's compareMagnitude. When the bit
+        // lengths already set the exponents apart the magnitudes differ,
+        // otherwise the scales differ by about the operand lengths at most
+        // and aligning them is cheap.
+        std::int64_t lLower;
+        std::int64_t lUpper;
+        std::int64_t rLower;
+        std::int64_t rUpper;
+        decimalDigitBounds(l.unscaled, lLower, lUpper);
+        decimalDigitBounds(r.unscaled, rLower, rUpper);
+        typedef detail::SignedDoubleLimb Wide;
+        if ((Wide)lUpper - l.fractionDigits <
+            (Wide)rLower - r.fractionDigits) {
+            return -lSign;
+        }
+        if ((Wide)lLower - l.fractionDigits >
+            (Wide)rUpper - r.fractionDigits) {
+            return lSign;
+        }
+
+        BigInteger aligned;
+        if (l.fractionDigits < r.fractionDigits) {
+            aligned = l.unscaled;
+            aligned.scaleByPowerOfTen(scaleDifference(r.fractionDigits,
+                                                      l.fractionDigits));
+            return compareIntegers(aligned, r.unscaled);
+        }
+
+        aligned = r.unscaled;
+        aligned.scaleByPowerOfTen(scaleDifference(l.fractionDigits,
+                                                  r.fractionDigits));
+        return compareIntegers(l.unscaled, aligned);
+    }
 
-        size_t i = 0;
-        for (; i < v.size(); i++) {
-            if (v[i] != 0) {
-                break;
-            }
+    // Drops the floating point digits, returns whether any were non zero.
+    static bool truncate(BigDecimal& a) {
+        if (a.fractionDigits <= 0) {
+            return false;
         }
 
-        v.erase(v.begin(), v.begin() + i);
+        BigInteger power = pow(BigInteger::ten(),
+                               (unsigned long long)a.fractionDigits);
+        BigInteger remainder = a.scratchInteger();
+        BigInteger quotient = a.scratchInteger();
+        BigInteger::divmod(a.unscaled, power, quotient, remainder);
+
+        a.unscaled = std::move(quotient);
+        a.fractionDigits = 0;
+        return !remainder.limbs.empty();
     }
-    
-    static void appendZeroes(std::vector<int>& v, long long int d) {
-        for (long long int i = 0; i < d; i++) {
-            v.push_back(0);
-        }
+};
+
+#if __cplusplus >= 201402L
+namespace detail {
+
+template <std::size_t N>
+struct DecimalLiteral {
+    LiteralLimbs<N> unscaled;
+    std::int64_t scale;
+};
+
+/*
+ * Parses the characters of a decimal floating point or integer literal,
+ * with an optional exponent and digit separators, into unscaled limbs and
+ * a scale. Anything else throws and fails the compilation.
+ */
+template <char... Chars>
+constexpr DecimalLiteral<(sizeof...(Chars) * 4 + LIMB_BITS - 1) / LIMB_BITS>
+parseDecimalLiteral() {
+    const char chars[] = {Chars...};
+    const std::size_t count = sizeof...(Chars);
+    DecimalLiteral<(sizeof...(Chars) * 4 + LIMB_BITS - 1) / LIMB_BITS> r{};
+
+    std::size_t i = 0;
+    bool point = false;
+    for (; i < count && chars[i] != 'e' && chars[i] != 'E'; i++) {
+        if (chars[i] == '\'') {
+            continue;
+        }
+        if (chars[i] == '.') {
+            point = true;
+            continue;
+        }
+        unsigned digit = literalDigit(chars[i]);
+        if (digit >= 10) {
+            throw std::invalid_argument("BigDecimal: invalid literal");
+        }
+        appendLiteralDigit(r.unscaled, 10, digit);
+        r.scale += point ? 1 : 0;
     }
 
-    static unsigned long long int countLeadingZeroes(const std::vector<int>& v) {
-        unsigned long long int numberOfZeroes = 0;
-        for (unsigned long long int i = 0; i < v.size(); i++) {
-            if (v[i] != 0) {
-                break;
+    if (i < count) {
+        i++;
+        bool negative = i < count && chars[i] == '-';
+        if (i < count && (chars[i] == '-' || chars[i] == '+')) {
+            i++;
+        }
+        std::int64_t exponent = 0;
+        for (; i < count; i++) {
+            if (chars[i] == '\'') {
+                continue;
+            }
+            unsigned digit = literalDigit(chars[i]);
+            if (digit >= 10) {
+                throw std::invalid_argument("BigDecimal: invalid literal");
             }
-            numberOfZeroes++;
+            exponent = exponent * 10 + digit;
         }
-        return numberOfZeroes;
+        r.scale += negative ? exponent : -exponent;
     }
+    return r;
+}
 
-    static std::vector<std::string> split(const std::string s, const char c) {
-        std::vector<std::string> splitted;
-        std::stringstream ss(s);
-        std::string element;
-        while (getline(ss, element, c)) {
-            splitted.push_back(element);
-        }
-        return splitted;
-    }
+} /* namespace detail */
 
-    static int positiveModulo(const int i, const int n) {
-        return (i % n + n) % n;
-    }
-};
+namespace literals {
+
+/*
+ * 3.14159265358979323846_bd or 6.02214076e23_bd, after using namespace
+ * BigNumerics::literals. The digits are converted to limbs at compile time
+ * and keep their scale, so 1.50_bd has scale 2.
+ */
+template <char... Chars>
+BigDecimal operator""_bd() {
+    static constexpr auto literal = detail::parseDecimalLiteral<Chars...>();
+    return BigDecimal::valueOf(BigInteger(literal.unscaled.limbs,
+                                          literal.unscaled.size),
+                               literal.scale);
+}
+
+} /* namespace literals */
+#endif
 
 } /* namespace BigNumerics */
 
+#endif
@@ -1,513 +1,5477 @@
+#ifndef BIGNUMERICS_BIGINTEGER_H
+#define BIGNUMERICS_BIGINTEGER_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
+#include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
-#include <cmath>
 
-namespace BigNumerics {
+#if __cplusplus >= 201703L
+#include <memory_resource>
+#define BIGNUMERICS_HAS_MEMORY_RESOURCE
+#endif
+
+#if !defined(BIGNUMERICS_NO_SIMD) && defined(__x86_64__) && \
+    (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define BIGNUMERICS_HAS_X86_SIMD
+#endif
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define BIGNUMERICS_LITTLE_ENDIAN
+#endif
+
+#if __cplusplus >= 202002L && defined(__has_include)
+#if __has_include(<span>)
+#include <span>
+#define BIGNUMERICS_HAS_SPAN
+#endif
+#endif
+
+#include "Expression.h"
+#include "Parallel.h"
+
+namespace BigNumerics {
+
+namespace detail {
+
+/*
+ * Magnitudes are stored as little-endian arrays of 64-bit limbs (radix
+ * 2^64). The kernels below work on raw limb pointers so that they can be
+ * shared by every algorithm built on top of them, the naming follows Knuth's
+ * Chapter 4.3.1 notation where it applies.
+ */
+typedef std::uint64_t Limb;
+__extension__ typedef unsigned __int128 DoubleLimb;
+__extension__ typedef __int128 SignedDoubleLimb;
+
+const int LIMB_BITS = 64;
+
+#ifndef BIGNUMERICS_INLINE_LIMBS
+#define BIGNUMERICS_INLINE_LIMBS 4
+#endif
+
+const std::size_t INLINE_LIMBS = BIGNUMERICS_INLINE_LIMBS;
+
+static_assert(BIGNUMERICS_INLINE_LIMBS >= 1,
+              "at least one limb must be stored inline");
+
+/*
+ * Heap limbs come from a std::pmr::memory_resource when compiling as C++17,
+ * which lets a whole computation run inside an arena. Older standards fall
+ * back to new and delete, with a null resource everywhere.
+ */
+#ifdef BIGNUMERICS_HAS_MEMORY_RESOURCE
+typedef std::pmr::memory_resource MemoryResource;
+
+inline MemoryResource* defaultMemoryResource() {
+    return std::pmr::get_default_resource();
+}
+
+inline Limb* allocateLimbs(MemoryResource* resource, std::size_t n) {
+    return static_cast<Limb*>(resource->allocate(n * sizeof(Limb),
+                                                 alignof(Limb)));
+}
+
+inline void deallocateLimbs(MemoryResource* resource, Limb* p,
+                            std::size_t n) {
+    resource->deallocate(p, n * sizeof(Limb), alignof(Limb));
+}
+#else
+struct MemoryResource;
+
+inline MemoryResource* defaultMemoryResource() {
+    return nullptr;
+}
+
+inline Limb* allocateLimbs(MemoryResource*, std::size_t n) {
+    return new Limb[n];
+}
+
+inline void deallocateLimbs(MemoryResource*, Limb* p, std::size_t) {
+    delete[] p;
+}
+#endif
+
+/*
+ * Limb storage with a small-buffer optimization: up to INLINE_LIMBS limbs
+ * live inside the object and only longer magnitudes go to the memory
+ * resource. The most significant bit of the size word holds a sign, which
+ * lets BigInteger carry its sign without a separate field. Growing keeps the
+ * limbs, new limbs are zero.
+ *
+ * Like the std::pmr containers, a copy uses the default resource and an
+ * assignment keeps the resource of its destination. swap() exchanges the
+ * resources along with the limbs.
+ */
+class LimbVector {
+
+public:
+    explicit LimbVector(MemoryResource* resource = defaultMemoryResource()) :
+        sizeAndSign{0}, capacity{INLINE_LIMBS}, resource{resource}, local{} {}
+
+    explicit LimbVector(std::size_t n,
+                        MemoryResource* resource = defaultMemoryResource()) :
+        LimbVector(resource) {
+        resize(n);
+    }
+
+    LimbVector(const LimbVector& other,
+               MemoryResource* resource = defaultMemoryResource()) :
+        LimbVector(resource) {
+        assign(other.data(), other.size());
+        setNegative(other.negative());
+    }
+
+    LimbVector(LimbVector&& other) noexcept : LimbVector(other.resource) {
+        swap(other);
+    }
+
+    LimbVector& operator=(const LimbVector& other) {
+        if (this != &other) {
+            assign(other.data(), other.size());
+            setNegative(other.negative());
+        }
+        return *this;
+    }
+
+    LimbVector& operator=(LimbVector&& other) {
+        if (this->resource == other.resource) {
+            swap(other);
+        }
+        else {
+            *this = other;
+        }
+        return *this;
+    }
+
+    ~LimbVector() {
+        if (onHeap()) {
+            deallocateLimbs(this->resource, this->heap, this->capacity);
+        }
+    }
+
+    MemoryResource* memoryResource() const {
+        return this->resource;
+    }
+
+    std::size_t size() const {
+        return this->sizeAndSign & ~SIGN_BIT;
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    bool negative() const {
+        return (this->sizeAndSign & SIGN_BIT) != 0;
+    }
+
+    void setNegative(bool negative) {
+        this->sizeAndSign = negative ? this->sizeAndSign | SIGN_BIT :
+            this->sizeAndSign & ~SIGN_BIT;
+    }
+
+    Limb* data() {
+        return onHeap() ? this->heap : this->local;
+    }
+
+    const Limb* data() const {
+        return onHeap() ? this->heap : this->local;
+    }
+
+    Limb& operator[](std::size_t i) {
+        return data()[i];
+    }
+
+    Limb operator[](std::size_t i) const {
+        return data()[i];
+    }
+
+    void reserve(std::size_t n) {
+        if (n <= this->capacity) {
+            return;
+        }
+
+        std::size_t newCapacity = std::max(n, 2 * this->capacity);
+        Limb* limbs = allocateLimbs(this->resource, newCapacity);
+        std::copy(data(), data() + size(), limbs);
+
+        if (onHeap()) {
+            deallocateLimbs(this->resource, this->heap, this->capacity);
+        }
+        this->heap = limbs;
+        this->capacity = newCapacity;
+    }
+
+    void resize(std::size_t n) {
+        reserve(n);
+        if (n > size()) {
+            std::fill(data() + size(), data() + n, 0);
+        }
+        setSize(n);
+    }
+
+    void push_back(Limb limb) {
+        std::size_t n = size();
+        reserve(n + 1);
+        data()[n] = limb;
+        setSize(n + 1);
+    }
+
+    void clear() {
+        setSize(0);
+    }
+
+    void assign(const Limb* a, std::size_t n) {
+        reserve(n);
+        std::copy(a, a + n, data());
+        setSize(n);
+    }
+
+    void swap(LimbVector& other) noexcept {
+        if (onHeap() && other.onHeap()) {
+            std::swap(this->heap, other.heap);
+        }
+        else if (!onHeap() && !other.onHeap()) {
+            std::swap_ranges(this->local, this->local + INLINE_LIMBS,
+                             other.local);
+        }
+        else {
+            LimbVector& h = onHeap() ? *this : other;
+            LimbVector& l = onHeap() ? other : *this;
+            Limb* limbs = h.heap;
+            std::copy(l.local, l.local + INLINE_LIMBS, h.local);
+            l.heap = limbs;
+        }
+
+        std::swap(this->sizeAndSign, other.sizeAndSign);
+        std::swap(this->capacity, other.capacity);
+        std::swap(this->resource, other.resource);
+    }
+
+    // Compares the magnitudes, the signs are ignored.
+    friend bool operator==(const LimbVector& l, const LimbVector& r) {
+        return l.size() == r.size() &&
+            std::equal(l.data(), l.data() + l.size(), r.data());
+    }
+
+private:
+    static const std::size_t SIGN_BIT =
+        (std::size_t)1 << (sizeof(std::size_t) * 8 - 1);
+
+    std::size_t sizeAndSign;
+    std::size_t capacity;
+    MemoryResource* resource;
+    union {
+        Limb* heap;
+        Limb local[INLINE_LIMBS];
+    };
+
+    bool onHeap() const {
+        return this->capacity > INLINE_LIMBS;
+    }
+
+    void setSize(std::size_t n) {
+        this->sizeAndSign = (this->sizeAndSign & SIGN_BIT) | n;
+    }
+};
+
+#ifndef BIGNUMERICS_IFMA_THRESHOLD
+#define BIGNUMERICS_IFMA_THRESHOLD 16
+#endif
+
+/*
+ * On processors with AVX-512 IFMA the schoolbook multiply goes through the
+ * vector kernel below once the shorter operand has this many limbs. Define
+ * BIGNUMERICS_IFMA_THRESHOLD before including this header to tune it.
+ */
+const std::size_t IFMA_THRESHOLD = BIGNUMERICS_IFMA_THRESHOLD;
+static_assert(BIGNUMERICS_IFMA_THRESHOLD >= 1,
+              "the IFMA threshold must be at least one limb");
+
+#ifdef BIGNUMERICS_HAS_X86_SIMD
+/*
+ * Vector kernels for x86-64. They are compiled through target attributes, so
+ * the rest of the library keeps the baseline instruction set, and are picked
+ * at run time from the CPUID bits below with the portable loops as fallback.
+ * Define BIGNUMERICS_NO_SIMD to leave only the portable loops.
+ */
+struct CpuFeatures {
+    bool avx2;
+    bool avx512;
+    bool ifma;
+};
+
+inline const CpuFeatures& cpuFeatures() {
+    static const CpuFeatures features = [] {
+        __builtin_cpu_init();
+        CpuFeatures f;
+        f.avx2 = __builtin_cpu_supports("avx2");
+        f.avx512 = __builtin_cpu_supports("avx512f");
+        f.ifma = f.avx512 && __builtin_cpu_supports("avx512ifma");
+        return f;
+    }();
+    return features;
+}
+
+/*
+ * Carry-lookahead addition eight limbs at a time. Lanes whose sum wrapped
+ * generate a carry and lanes that summed to all ones propagate one, adding
+ * the generate mask shifted by a lane to the propagate mask resolves the
+ * carries of the whole vector in a single scalar addition.
+ */
+__attribute__((target("avx512f")))
+inline Limb addNAvx512(Limb* r, const Limb* a, const Limb* b, std::size_t n) {
+    const __m512i ones = _mm512_set1_epi64(-1);
+    unsigned carry = 0;
+    for (std::size_t i = 0; i < n; i += 8) {
+        unsigned lanes = (unsigned)std::min<std::size_t>(n - i, 8);
+        __mmask8 live = (__mmask8)((1u << lanes) - 1);
+        __m512i x = _mm512_maskz_loadu_epi64(live, a + i);
+        __m512i y = _mm512_maskz_loadu_epi64(live, b + i);
+        __m512i s = _mm512_add_epi64(x, y);
+        unsigned generate = _mm512_cmplt_epu64_mask(s, x);
+        unsigned propagate = _mm512_cmpeq_epi64_mask(s, ones);
+        unsigned g = (generate << 1) + carry + propagate;
+        s = _mm512_mask_sub_epi64(s, (__mmask8)(g ^ propagate), s, ones);
+        _mm512_mask_storeu_epi64(r + i, live, s);
+        carry = (g >> lanes) & 1;
+    }
+    return carry;
+}
+
+// The same lookahead for subtraction, a zero difference propagates a borrow.
+__attribute__((target("avx512f")))
+inline Limb subNAvx512(Limb* r, const Limb* a, const Limb* b, std::size_t n) {
+    const __m512i ones = _mm512_set1_epi64(-1);
+    const __m512i zero = _mm512_setzero_si512();
+    unsigned borrow = 0;
+    for (std::size_t i = 0; i < n; i += 8) {
+        unsigned lanes = (unsigned)std::min<std::size_t>(n - i, 8);
+        __mmask8 live = (__mmask8)((1u << lanes) - 1);
+        __m512i x = _mm512_maskz_loadu_epi64(live, a + i);
+        __m512i y = _mm512_maskz_loadu_epi64(live, b + i);
+        __m512i d = _mm512_sub_epi64(x, y);
+        unsigned generate = _mm512_cmplt_epu64_mask(x, y);
+        unsigned propagate = _mm512_mask_cmpeq_epi64_mask(live, d, zero);
+        unsigned g = (generate << 1) + borrow + propagate;
+        d = _mm512_mask_add_epi64(d, (__mmask8)(g ^ propagate), d, ones);
+        _mm512_mask_storeu_epi64(r + i, live, d);
+        borrow = (g >> lanes) & 1;
+    }
+    return borrow;
+}
+
+/*
+ * low += a for a carry-save sum, counting the carries out of every limb in
+ * carries instead of propagating them (see CarrySaveSum).
+ */
+__attribute__((target("avx512f")))
+inline void addCarrySaveAvx512(Limb* low, Limb* carries, const Limb* a,
+                               std::size_t n) {
+    const __m512i ones = _mm512_set1_epi64(-1);
+    for (std::size_t i = 0; i < n; i += 8) {
+        unsigned lanes = (unsigned)std::min<std::size_t>(n - i, 8);
+        __mmask8 live = (__mmask8)((1u << lanes) - 1);
+        __m512i x = _mm512_maskz_loadu_epi64(live, low + i);
+        __m512i y = _mm512_maskz_loadu_epi64(live, a + i);
+        __m512i c = _mm512_maskz_loadu_epi64(live, carries + i);
+        __m512i s = _mm512_add_epi64(x, y);
+        c = _mm512_mask_sub_epi64(c, _mm512_cmplt_epu64_mask(s, y), c, ones);
+        _mm512_mask_storeu_epi64(low + i, live, s);
+        _mm512_mask_storeu_epi64(carries + i, live, c);
+    }
+}
+
+/*
+ * AVX2 flavours of the above, four limbs at a time. AVX2 only compares
+ * signed lanes, flipping the sign bits turns that into an unsigned compare,
+ * and the lane masks are rebuilt from the scalar carry bits.
+ */
+__attribute__((target("avx2")))
+inline unsigned laneMask(__m256i v) {
+    return (unsigned)_mm256_movemask_pd(_mm256_castsi256_pd(v));
+}
+
+__attribute__((target("avx2")))
+inline __m256i laneSelect(unsigned mask) {
+    const __m256i bits = _mm256_setr_epi64x(1, 2, 4, 8);
+    __m256i m = _mm256_and_si256(_mm256_set1_epi64x(mask), bits);
+    return _mm256_cmpeq_epi64(m, bits);
+}
+
+__attribute__((target("avx2")))
+inline Limb addNAvx2(Limb* r, const Limb* a, const Limb* b, std::size_t n) {
+    const __m256i ones = _mm256_set1_epi64x(-1);
+    const __m256i sign = _mm256_set1_epi64x(INT64_MIN);
+    unsigned carry = 0;
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i y = _mm256_loadu_si256((const __m256i*)(b + i));
+        __m256i s = _mm256_add_epi64(x, y);
+        unsigned generate = laneMask(_mm256_cmpgt_epi64(
+            _mm256_xor_si256(x, sign), _mm256_xor_si256(s, sign)));
+        unsigned propagate = laneMask(_mm256_cmpeq_epi64(s, ones));
+        unsigned g = (generate << 1) + carry + propagate;
+        s = _mm256_sub_epi64(s, laneSelect(g ^ propagate));
+        _mm256_storeu_si256((__m256i*)(r + i), s);
+        carry = g >> 4;
+    }
+    for (; i < n; i++) {
+        DoubleLimb t = (DoubleLimb)a[i] + b[i] + carry;
+        r[i] = (Limb)t;
+        carry = (unsigned)(t >> LIMB_BITS);
+    }
+    return carry;
+}
+
+__attribute__((target("avx2")))
+inline Limb subNAvx2(Limb* r, const Limb* a, const Limb* b, std::size_t n) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i sign = _mm256_set1_epi64x(INT64_MIN);
+    unsigned borrow = 0;
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i y = _mm256_loadu_si256((const __m256i*)(b + i));
+        __m256i d = _mm256_sub_epi64(x, y);
+        unsigned generate = laneMask(_mm256_cmpgt_epi64(
+            _mm256_xor_si256(y, sign), _mm256_xor_si256(x, sign)));
+        unsigned propagate = laneMask(_mm256_cmpeq_epi64(d, zero));
+        unsigned g = (generate << 1) + borrow + propagate;
+        d = _mm256_add_epi64(d, laneSelect(g ^ propagate));
+        _mm256_storeu_si256((__m256i*)(r + i), d);
+        borrow = g >> 4;
+    }
+    for (; i < n; i++) {
+        Limb ai = a[i];
+        Limb bi = b[i];
+        Limb d = ai - bi;
+        unsigned borrowOut = ai < bi;
+        r[i] = d - borrow;
+        borrow = borrowOut | (d < borrow);
+    }
+    return borrow;
+}
+
+/*
+ * IFMA multiplies 52-bit digits, so the operands of mulIfma are split into
+ * digits of that size first. Both operands are bounded so that the scratch
+ * fits on the stack and no column sum can overflow its 64 bits: IFMA_ROW_LIMBS
+ * is exactly 48 digits, longer operands are multiplied by slices of it.
+ */
+const int DIGIT_BITS = 52;
+const Limb DIGIT_MASK = ((Limb)1 << DIGIT_BITS) - 1;
+const std::size_t IFMA_MAX_LIMBS = 64;
+const std::size_t IFMA_ROW_LIMBS = 39;
+const std::size_t IFMA_MAX_VECTORS = 10;
+
+inline std::size_t digitCount(std::size_t n) {
+    return (n * LIMB_BITS + DIGIT_BITS - 1) / DIGIT_BITS;
+}
+
+inline void toDigits(Limb* d, std::size_t nd, const Limb* a, std::size_t n) {
+    for (std::size_t i = 0; i < nd; i++) {
+        std::size_t bit = i * DIGIT_BITS;
+        std::size_t q = bit / LIMB_BITS;
+        unsigned s = bit % LIMB_BITS;
+        Limb v = a[q] >> s;
+        if (s > LIMB_BITS - DIGIT_BITS && q + 1 < n) {
+            v |= a[q + 1] << (LIMB_BITS - s);
+        }
+        d[i] = v & DIGIT_MASK;
+    }
+}
+
+/*
+ * Column sums of x * y in radix 2^52, x held in K vectors of eight digits.
+ * Each digit of y adds the low halves of its row, retires the lowest column
+ * and shifts the accumulators down one digit before adding the high halves.
+ */
+template <std::size_t K>
+__attribute__((target("avx512f,avx512ifma")))
+inline void ifmaColumns(Limb* column, const Limb* x, const Limb* y,
+                        std::size_t yn) {
+    __m512i acc[K + 1];
+    __m512i xv[K];
+    for (std::size_t k = 0; k < K; k++) {
+        acc[k] = _mm512_setzero_si512();
+        xv[k] = _mm512_loadu_si512(x + 8 * k);
+    }
+    acc[K] = _mm512_setzero_si512();
+
+    for (std::size_t j = 0; j < yn; j++) {
+        __m512i yj = _mm512_set1_epi64((long long)y[j]);
+        for (std::size_t k = 0; k < K; k++) {
+            acc[k] = _mm512_madd52lo_epu64(acc[k], xv[k], yj);
+        }
+        _mm512_mask_storeu_epi64(column + j, 1, acc[0]);
+        for (std::size_t k = 0; k < K; k++) {
+            acc[k] = _mm512_maskz_alignr_epi64(0xff, acc[k + 1], acc[k], 1);
+        }
+        for (std::size_t k = 0; k < K; k++) {
+            acc[k] = _mm512_madd52hi_epu64(acc[k], xv[k], yj);
+        }
+    }
+
+    for (std::size_t k = 0; k < K; k++) {
+        _mm512_storeu_si512(column + yn + 8 * k, acc[k]);
+    }
+}
+
+/*
+ * r = a * b for an <= IFMA_ROW_LIMBS and bn <= IFMA_MAX_LIMBS, r holds an + bn
+ * limbs and must not overlap a or b.
+ */
+__attribute__((target("avx512f,avx512ifma")))
+inline void mulIfma(Limb* r, const Limb* a, std::size_t an,
+                    const Limb* b, std::size_t bn) {
+    Limb x[8 * IFMA_MAX_VECTORS];
+    Limb y[IFMA_ROW_LIMBS * LIMB_BITS / DIGIT_BITS];
+    Limb column[IFMA_ROW_LIMBS * LIMB_BITS / DIGIT_BITS +
+                8 * IFMA_MAX_VECTORS];
+
+    std::size_t xn = digitCount(bn);
+    std::size_t yn = digitCount(an);
+    std::size_t vectors = xn / 8 + 1;
+    toDigits(x, xn, b, bn);
+    std::fill(x + xn, x + 8 * vectors, 0);
+    toDigits(y, yn, a, an);
+
+    switch (vectors) {
+    case 1: ifmaColumns<1>(column, x, y, yn); break;
+    case 2: ifmaColumns<2>(column, x, y, yn); break;
+    case 3: ifmaColumns<3>(column, x, y, yn); break;
+    case 4: ifmaColumns<4>(column, x, y, yn); break;
+    case 5: ifmaColumns<5>(column, x, y, yn); break;
+    case 6: ifmaColumns<6>(column, x, y, yn); break;
+    case 7: ifmaColumns<7>(column, x, y, yn); break;
+    case 8: ifmaColumns<8>(column, x, y, yn); break;
+    case 9: ifmaColumns<9>(column, x, y, yn); break;
+    default: ifmaColumns<10>(column, x, y, yn); break;
+    }
+
+    // Carry the columns into 52-bit digits and pack those into limbs.
+    DoubleLimb window = 0;
+    unsigned bits = 0;
+    Limb carry = 0;
+    std::size_t rn = an + bn;
+    for (std::size_t i = 0, out = 0; out < rn; i++) {
+        Limb v = column[i] + carry;
+        carry = v >> DIGIT_BITS;
+        window |= (DoubleLimb)(v & DIGIT_MASK) << bits;
+        bits += DIGIT_BITS;
+        if (bits >= LIMB_BITS) {
+            r[out++] = (Limb)window;
+            window >>= LIMB_BITS;
+            bits -= LIMB_BITS;
+        }
+    }
+}
+#endif
+
+// r = a + b, returns the carry out of the most significant limb.
+inline Limb add1(Limb* r, const Limb* a, std::size_t n, Limb b) {
+    std::size_t i = 0;
+    for (; i < n && b != 0; i++) {
+        Limb s = a[i] + b;
+        b = s < b;
+        r[i] = s;
+    }
+
+    if (r != a) {
+        std::copy(a + i, a + n, r + i);
+    }
+
+    return b;
+}
+
+// r = a + b where a and b are both n limbs long, r may alias a or b.
+inline Limb addN(Limb* r, const Limb* a, const Limb* b, std::size_t n) {
+#ifdef BIGNUMERICS_HAS_X86_SIMD
+    // Below a full vector the scalar loop wins.
+    if (n >= 8 && cpuFeatures().avx512) {
+        return addNAvx512(r, a, b, n);
+    }
+    else if (n >= 8 && cpuFeatures().avx2) {
+        return addNAvx2(r, a, b, n);
+    }
+#endif
+    Limb carry = 0;
+    for (std::size_t i = 0; i < n; i++) {
+        DoubleLimb t = (DoubleLimb)a[i] + b[i] + carry;
+        r[i] = (Limb)t;
+        carry = (Limb)(t >> LIMB_BITS);
+    }
+    return carry;
+}
+
+// r = a + b where an >= bn, r holds an limbs.
+inline Limb add(Limb* r, const Limb* a, std::size_t an,
+                const Limb* b, std::size_t bn) {
+    Limb carry = addN(r, a, b, bn);
+    return add1(r + bn, a + bn, an - bn, carry);
+}
+
+// r = a - b, returns the borrow out of the most significant limb.
+inline Limb sub1(Limb* r, const Limb* a, std::size_t n, Limb b) {
+    std::size_t i = 0;
+    for (; i < n && b != 0; i++) {
+        Limb ai = a[i];
+        r[i] = ai - b;
+        b = ai < b;
+    }
+
+    if (r != a) {
+        std::copy(a + i, a + n, r + i);
+    }
+
+    return b;
+}
+
+// r = a - b where a and b are both n limbs long, r may alias a or b.
+inline Limb subN(Limb* r, const Limb* a, const Limb* b, std::size_t n) {
+#ifdef BIGNUMERICS_HAS_X86_SIMD
+    if (n >= 8 && cpuFeatures().avx512) {
+        return subNAvx512(r, a, b, n);
+    }
+    else if (n >= 8 && cpuFeatures().avx2) {
+        return subNAvx2(r, a, b, n);
+    }
+#endif
+    Limb borrow = 0;
+    for (std::size_t i = 0; i < n; i++) {
+        Limb ai = a[i];
+        Limb bi = b[i];
+        Limb d = ai - bi;
+        Limb borrowOut = ai < bi;
+        r[i] = d - borrow;
+        borrow = borrowOut | (d < borrow);
+    }
+    return borrow;
+}
+
+// r = a - b where an >= bn, r holds an limbs.
+inline Limb sub(Limb* r, const Limb* a, std::size_t an,
+                const Limb* b, std::size_t bn) {
+    Limb borrow = subN(r, a, b, bn);
+    return sub1(r + bn, a + bn, an - bn, borrow);
+}
+
+// r = a * b, returns the most significant limb of the product.
+inline Limb mul1(Limb* r, const Limb* a, std::size_t n, Limb b) {
+    Limb carry = 0;
+    for (std::size_t i = 0; i < n; i++) {
+        DoubleLimb t = (DoubleLimb)a[i] * b + carry;
+        r[i] = (Limb)t;
+        carry = (Limb)(t >> LIMB_BITS);
+    }
+    return carry;
+}
+
+// r += a * b, returns the limb carried out of r[n - 1].
+inline Limb addMul1(Limb* r, const Limb* a, std::size_t n, Limb b) {
+    Limb carry = 0;
+    for (std::size_t i = 0; i < n; i++) {
+        DoubleLimb t = (DoubleLimb)a[i] * b + r[i] + carry;
+        r[i] = (Limb)t;
+        carry = (Limb)(t >> LIMB_BITS);
+    }
+    return carry;
+}
+
+// r -= a * b, returns the limb borrowed out of r[n - 1].
+inline Limb subMul1(Limb* r, const Limb* a, std::size_t n, Limb b) {
+    Limb carry = 0;
+    for (std::size_t i = 0; i < n; i++) {
+        DoubleLimb t = (DoubleLimb)a[i] * b + carry;
+        Limb low = (Limb)t;
+        Limb ri = r[i];
+        carry = (Limb)(t >> LIMB_BITS) + (ri < low);
+        r[i] = ri - low;
+    }
+    return carry;
+}
+
+// Algorithm 4.3.1 M, r must hold an + bn limbs and must not overlap a or b.
+inline void mulBasecase(Limb* r, const Limb* a, std::size_t an,
+                        const Limb* b, std::size_t bn) {
+#ifdef BIGNUMERICS_HAS_X86_SIMD
+    if (an < bn) {
+        std::swap(a, b);
+        std::swap(an, bn);
+    }
+
+    if (bn >= IFMA_THRESHOLD && bn <= IFMA_MAX_LIMBS && cpuFeatures().ifma) {
+        mulIfma(r, a, std::min(an, IFMA_ROW_LIMBS), b, bn);
+        for (std::size_t i = IFMA_ROW_LIMBS; i < an; i += IFMA_ROW_LIMBS) {
+            Limb slice[IFMA_ROW_LIMBS + IFMA_MAX_LIMBS];
+            std::size_t size = std::min(IFMA_ROW_LIMBS, an - i);
+            mulIfma(slice, a + i, size, b, bn);
+            add(r + i, slice, size + bn, r + i, bn);
+        }
+        return;
+    }
+#endif
+    r[an] = mul1(r, a, an, b[0]);
+    for (std::size_t j = 1; j < bn; j++) {
+        r[an + j] = addMul1(r + j, a, an, b[j]);
+    }
+}
+
+/*
+ * The sum of the partial products a[i] b[j] with i + j >= skip, which falls
+ * short of a b by less than skip 2^(64 (skip + 1)). r holds an + bn limbs
+ * and must not overlap a or b.
+ */
+inline void mulHighBasecase(Limb* r, const Limb* a, std::size_t an,
+                            const Limb* b, std::size_t bn, std::size_t skip) {
+    std::fill(r, r + an + bn, 0);
+    for (std::size_t j = 0; j < bn; j++) {
+        std::size_t i = skip > j ? std::min(skip - j, an) : 0;
+        r[j + an] = addMul1(r + j + i, a + i, an - i, b[j]);
+    }
+}
+
+// r = a b mod 2^(64 rn), r must not overlap a or b.
+inline void mulLowBasecase(Limb* r, const Limb* a, std::size_t an,
+                           const Limb* b, std::size_t bn, std::size_t rn) {
+    std::fill(r, r + rn, 0);
+    for (std::size_t j = 0; j < bn && j < rn; j++) {
+        std::size_t size = std::min(an, rn - j);
+        Limb carry = addMul1(r + j, a, size, b[j]);
+        if (j + size < rn) {
+            r[j + size] = carry;
+        }
+    }
+}
+
+// r = a << s with 0 < s < LIMB_BITS, r may alias a.
+inline Limb lshift(Limb* r, const Limb* a, std::size_t n, unsigned s) {
+    Limb out = a[n - 1] >> (LIMB_BITS - s);
+    for (std::size_t i = n - 1; i > 0; i--) {
+        r[i] = (a[i] << s) | (a[i - 1] >> (LIMB_BITS - s));
+    }
+    r[0] = a[0] << s;
+    return out;
+}
+
+// r = a >> s with 0 < s < LIMB_BITS, r may alias a.
+inline Limb rshift(Limb* r, const Limb* a, std::size_t n, unsigned s) {
+    Limb out = a[0] << (LIMB_BITS - s);
+    for (std::size_t i = 0; i + 1 < n; i++) {
+        r[i] = (a[i] >> s) | (a[i + 1] << (LIMB_BITS - s));
+    }
+    r[n - 1] = a[n - 1] >> s;
+    return out;
+}
+
+/*
+ * r = a^2, r holds 2n limbs and must not overlap a. The products a[i] a[j]
+ * with i < j are summed once and doubled before the squares a[i]^2 are added
+ * along the diagonal, about half the work of mulBasecase(r, a, n, a, n).
+ */
+inline void sqrBasecase(Limb* r, const Limb* a, std::size_t n) {
+    r[0] = 0;
+    r[2 * n - 1] = 0;
+    if (n > 1) {
+        r[n] = mul1(r + 1, a + 1, n - 1, a[0]);
+        for (std::size_t i = 1; i + 1 < n; i++) {
+            r[n + i] = addMul1(r + 2 * i + 1, a + i + 1, n - i - 1, a[i]);
+        }
+    }
+
+    // Doubling and the diagonal in one pass, bit is the one shifted out of
+    // the previous limb.
+    Limb bit = 0;
+    Limb carry = 0;
+    for (std::size_t i = 0; i < n; i++) {
+        Limb low = r[2 * i];
+        Limb high = r[2 * i + 1];
+        DoubleLimb square = (DoubleLimb)a[i] * a[i];
+        DoubleLimb sum = (DoubleLimb)((low << 1) | bit) + (Limb)square +
+            carry;
+        r[2 * i] = (Limb)sum;
+        sum = (DoubleLimb)((high << 1) | (low >> (LIMB_BITS - 1))) +
+            (Limb)(square >> LIMB_BITS) + (Limb)(sum >> LIMB_BITS);
+        r[2 * i + 1] = (Limb)sum;
+        carry = (Limb)(sum >> LIMB_BITS);
+        bit = high >> (LIMB_BITS - 1);
+    }
+}
+
+inline int cmp(const Limb* a, const Limb* b, std::size_t n) {
+    for (std::size_t i = n; i > 0; i--) {
+        if (a[i - 1] != b[i - 1]) {
+            return a[i - 1] < b[i - 1] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+inline std::size_t normalizedSize(const Limb* a, std::size_t n) {
+    while (n > 0 && a[n - 1] == 0) {
+        n--;
+    }
+    return n;
+}
+
+inline unsigned countLeadingZeroes(Limb x) {
+    return x == 0 ? LIMB_BITS : __builtin_clzll(x);
+}
+
+// (hi * 2^64 + lo) / d, requires hi < d so that the quotient fits in a limb.
+inline Limb divideDoubleLimb(Limb hi, Limb lo, Limb d, Limb& remainder) {
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    Limb q;
+    __asm__("divq %4" : "=a"(q), "=d"(remainder) : "0"(lo), "1"(hi), "rm"(d));
+    return q;
+#else
+    DoubleLimb n = ((DoubleLimb)hi << LIMB_BITS) | lo;
+    remainder = (Limb)(n % d);
+    return (Limb)(n / d);
+#endif
+}
+
+// q = a / d, returns a mod d. q may alias a.
+inline Limb divRem1(Limb* q, const Limb* a, std::size_t n, Limb d) {
+    Limb r = 0;
+    for (std::size_t i = n; i > 0; i--) {
+        q[i - 1] = divideDoubleLimb(r, a[i - 1], d, r);
+    }
+    return r;
+}
+
+/*
+ * Algorithm 4.3.1 D. u holds un + 1 limbs and v holds vn >= 2 limbs, both
+ * already shifted so that the top bit of v[vn - 1] is set (step D1). The
+ * un - vn + 1 quotient limbs are written to q and u is left holding the
+ * normalized remainder in its low vn limbs.
+ */
+inline void divideKnuth(Limb* q, Limb* u, std::size_t un,
+                        const Limb* v, std::size_t vn) {
+    Limb v1 = v[vn - 1];
+    Limb v2 = v[vn - 2];
+
+    // D2
+    for (std::size_t j = un - vn + 1; j-- > 0;) {
+        // D3
+        Limb qHat;
+        Limb rHat;
+        bool rHatOverflow = false;
+
+        if (u[j + vn] >= v1) {
+            qHat = ~(Limb)0;
+            rHat = u[j + vn - 1] + v1;
+            rHatOverflow = rHat < v1;
+        }
+        else {
+            qHat = divideDoubleLimb(u[j + vn], u[j + vn - 1], v1, rHat);
+        }
+
+        while (!rHatOverflow) {
+            DoubleLimb p = (DoubleLimb)qHat * v2;
+            Limb pHigh = (Limb)(p >> LIMB_BITS);
+            if (pHigh < rHat || (pHigh == rHat && (Limb)p <= u[j + vn - 2])) {
+                break;
+            }
+            qHat--;
+            rHat += v1;
+            rHatOverflow = rHat < v1;
+        }
+
+        // D4
+        Limb borrow = subMul1(u + j, v, vn, qHat);
+        Limb top = u[j + vn];
+        u[j + vn] = top - borrow;
+
+        // D5
+        if (top < borrow) {
+            // D6
+            qHat--;
+            u[j + vn] += addN(u + j, u + j, v, vn);
+        }
+
+        q[j] = qHat;
+
+        // D7
+    }
+}
+
+#ifndef BIGNUMERICS_KARATSUBA_THRESHOLD
+#define BIGNUMERICS_KARATSUBA_THRESHOLD 24
+#endif
+
+/*
+ * Operands with fewer limbs than this are multiplied with the schoolbook
+ * loop, larger ones go through Karatsuba. Define
+ * BIGNUMERICS_KARATSUBA_THRESHOLD before including this header to tune it.
+ */
+const std::size_t KARATSUBA_THRESHOLD = BIGNUMERICS_KARATSUBA_THRESHOLD;
+static_assert(BIGNUMERICS_KARATSUBA_THRESHOLD >= 2,
+              "the Karatsuba threshold must be at least two limbs");
+
+#ifndef BIGNUMERICS_SQR_KARATSUBA_THRESHOLD
+#define BIGNUMERICS_SQR_KARATSUBA_THRESHOLD 32
+#endif
+
+/*
+ * The same crossover for squares, whose schoolbook loop only computes half
+ * of the partial products and so stays ahead of Karatsuba for longer.
+ */
+const std::size_t SQR_KARATSUBA_THRESHOLD =
+    BIGNUMERICS_SQR_KARATSUBA_THRESHOLD;
+static_assert(BIGNUMERICS_SQR_KARATSUBA_THRESHOLD >= 2,
+              "the Karatsuba threshold must be at least two limbs");
+
+// r = |a - b| for n limb operands, returns true when a < b.
+inline bool subAbsN(Limb* r, const Limb* a, const Limb* b, std::size_t n) {
+    if (cmp(a, b, n) < 0) {
+        subN(r, b, a, n);
+        return true;
+    }
+    subN(r, a, b, n);
+    return false;
+}
+
+// Number of scratch limbs used by mulKaratsuba and sqrKaratsuba for n limb
+// operands.
+inline std::size_t karatsubaScratchSize(std::size_t n) {
+    std::size_t size = 0;
+    while (n >= std::min(KARATSUBA_THRESHOLD, SQR_KARATSUBA_THRESHOLD)) {
+        std::size_t k = n - n / 2;
+        size += 6 * k + 1;
+        n = k;
+    }
+    return size;
+}
+
+/*
+ * r = a * b for two n limb operands, r holds 2n limbs. Writing
+ * a = a1 B^h + a0 and b = b1 B^h + b0, the middle product is recovered as
+ * a0 b0 + a1 b1 - (a1 - a0)(b1 - b0), so each level costs three half size
+ * products. scratch must hold karatsubaScratchSize(n) limbs and is shared by
+ * all recursion levels.
+ */
+inline void mulKaratsuba(Limb* r, const Limb* a, const Limb* b,
+                         std::size_t n, Limb* scratch) {
+    if (n < KARATSUBA_THRESHOLD) {
+        mulBasecase(r, a, n, b, n);
+        return;
+    }
+
+    std::size_t h = n / 2;
+    std::size_t k = n - h;
+
+    Limb* dA = scratch;
+    Limb* dB = dA + k;
+    Limb* product = dB + k;
+    Limb* middle = product + 2 * k;
+    Limb* next = middle + 2 * k + 1;
+
+    // |a1 - a0| and |b1 - b0|, a0 and b0 are zero extended to k limbs.
+    bool aNegative;
+    bool bNegative;
+    if (h == k) {
+        aNegative = subAbsN(dA, a + h, a, k);
+        bNegative = subAbsN(dB, b + h, b, k);
+    }
+    else {
+        aNegative = a[n - 1] == 0 && cmp(a + h, a, h) < 0;
+        if (aNegative) {
+            subN(dA, a, a + h, h);
+            dA[h] = 0;
+        }
+        else {
+            dA[h] = a[n - 1] - subN(dA, a + h, a, h);
+        }
+
+        bNegative = b[n - 1] == 0 && cmp(b + h, b, h) < 0;
+        if (bNegative) {
+            subN(dB, b, b + h, h);
+            dB[h] = 0;
+        }
+        else {
+            dB[h] = b[n - 1] - subN(dB, b + h, b, h);
+        }
+    }
+
+    if (forkable(n)) {
+        // Parallel branches cannot share the scratch below this level.
+        std::vector<Limb> high(karatsubaScratchSize(k));
+        std::vector<Limb> low(karatsubaScratchSize(k));
+        TaskGroup tasks;
+        tasks.run([&] { mulKaratsuba(r, a, b, h, low.data()); });
+        tasks.run([&] {
+            mulKaratsuba(r + 2 * h, a + h, b + h, k, high.data());
+        });
+        mulKaratsuba(product, dA, dB, k, next);
+        tasks.wait();
+    }
+    else {
+        mulKaratsuba(r, a, b, h, next);
+        mulKaratsuba(r + 2 * h, a + h, b + h, k, next);
+        mulKaratsuba(product, dA, dB, k, next);
+    }
+
+    // middle = a0 b0 + a1 b1 -/+ (a1 - a0)(b1 - b0)
+    middle[2 * k] = add(middle, r + 2 * h, 2 * k, r, 2 * h);
+    if (aNegative == bNegative) {
+        middle[2 * k] -= subN(middle, middle, product, 2 * k);
+    }
+    else {
+        middle[2 * k] += addN(middle, middle, product, 2 * k);
+    }
+
+    add(r + h, r + h, 2 * n - h, middle, 2 * k + 1);
+}
+
+/*
+ * r = a^2 for an n limb operand, r holds 2n limbs. The middle product is
+ * a0^2 + a1^2 - (a1 - a0)^2, so there is only one difference to form and
+ * no sign to track. scratch must hold karatsubaScratchSize(n) limbs.
+ */
+inline void sqrKaratsuba(Limb* r, const Limb* a, std::size_t n,
+                         Limb* scratch) {
+    if (n < SQR_KARATSUBA_THRESHOLD) {
+        sqrBasecase(r, a, n);
+        return;
+    }
+
+    std::size_t h = n / 2;
+    std::size_t k = n - h;
+
+    Limb* d = scratch;
+    Limb* product = d + k;
+    Limb* middle = product + 2 * k;
+    Limb* next = middle + 2 * k + 1;
+
+    // |a1 - a0|, a0 is zero extended to k limbs.
+    if (h == k) {
+        subAbsN(d, a + h, a, k);
+    }
+    else if (a[n - 1] == 0 && cmp(a + h, a, h) < 0) {
+        subN(d, a, a + h, h);
+        d[h] = 0;
+    }
+    else {
+        d[h] = a[n - 1] - subN(d, a + h, a, h);
+    }
+
+    if (forkable(n)) {
+        std::vector<Limb> high(karatsubaScratchSize(k));
+        std::vector<Limb> low(karatsubaScratchSize(k));
+        TaskGroup tasks;
+        tasks.run([&] { sqrKaratsuba(r, a, h, low.data()); });
+        tasks.run([&] { sqrKaratsuba(r + 2 * h, a + h, k, high.data()); });
+        sqrKaratsuba(product, d, k, next);
+        tasks.wait();
+    }
+    else {
+        sqrKaratsuba(r, a, h, next);
+        sqrKaratsuba(r + 2 * h, a + h, k, next);
+        sqrKaratsuba(product, d, k, next);
+    }
+
+    middle[2 * k] = add(middle, r + 2 * h, 2 * k, r, 2 * h);
+    middle[2 * k] -= subN(middle, middle, product, 2 * k);
+
+    add(r + h, r + h, 2 * n - h, middle, 2 * k + 1);
+}
+
+#ifndef BIGNUMERICS_TOOM3_THRESHOLD
+#define BIGNUMERICS_TOOM3_THRESHOLD 200
+#endif
+
+#ifndef BIGNUMERICS_TOOM4_THRESHOLD
+#define BIGNUMERICS_TOOM4_THRESHOLD 800
+#endif
+
+/*
+ * Once the shorter operand reaches TOOM3_THRESHOLD limbs the product goes
+ * through Toom-Cook, three way (or Toom-32/Toom-42 for unbalanced operands)
+ * and four way from TOOM4_THRESHOLD on.
+ */
+const std::size_t TOOM3_THRESHOLD = BIGNUMERICS_TOOM3_THRESHOLD;
+const std::size_t TOOM4_THRESHOLD = BIGNUMERICS_TOOM4_THRESHOLD;
+
+inline void mul(Limb* r, const Limb* a, std::size_t an,
+                const Limb* b, std::size_t bn);
+
+// Inverse of an odd d modulo 2^64, by Newton iteration.
+inline Limb inverseModLimb(Limb d) {
+    Limb inverse = d;
+    for (int i = 0; i < 5; i++) {
+        inverse *= 2 - d * inverse;
+    }
+    return inverse;
+}
+
+/*
+ * q = a / d when d is known to divide a exactly. Odd divisors use the
+ * multiplication by the inverse of d modulo 2^64 instead of a division per
+ * limb. q may alias a.
+ */
+inline void divExact1(Limb* q, const Limb* a, std::size_t n, Limb d) {
+    if (n == 0) {
+        return;
+    }
+
+    unsigned shift = __builtin_ctzll(d);
+    d >>= shift;
+
+    if (shift > 0) {
+        rshift(q, a, n, shift);
+        a = q;
+    }
+
+    Limb inverse = inverseModLimb(d);
+    Limb borrow = 0;
+    for (std::size_t i = 0; i < n; i++) {
+        Limb s = a[i];
+        Limb l = s - borrow;
+        borrow = l > s;
+        Limb qi = l * inverse;
+        q[i] = qi;
+        borrow += (Limb)(((DoubleLimb)qi * d) >> LIMB_BITS);
+    }
+}
+
+// Signed intermediate value of the Toom-Cook evaluation and interpolation.
+struct SignedLimbs {
+    std::vector<Limb> limbs;
+    bool negative;
+
+    SignedLimbs() : limbs{}, negative{false} {}
+
+    SignedLimbs(const Limb* a, std::size_t n) :
+        limbs(a, a + normalizedSize(a, n)), negative{false} {}
+
+    void normalize() {
+        this->limbs.resize(normalizedSize(this->limbs.data(),
+                                          this->limbs.size()));
+        if (this->limbs.empty()) {
+            this->negative = false;
+        }
+    }
+
+    // this += b, or this -= b when subtract is set.
+    void add(const SignedLimbs& b, bool subtract) {
+        add(b.limbs.data(), b.limbs.size(), b.negative != subtract);
+    }
+
+    // this += b for the bn limb magnitude b with the given sign.
+    void add(const Limb* b, std::size_t bn, bool bNegative) {
+        std::size_t an = this->limbs.size();
+
+        if (this->negative == bNegative) {
+            this->limbs.resize(std::max(an, bn) + 1, 0);
+            detail::add(this->limbs.data(), this->limbs.data(),
+                        this->limbs.size(), b, bn);
+        }
+        else if (an > bn || (an == bn &&
+                 cmp(this->limbs.data(), b, an) >= 0)) {
+            sub(this->limbs.data(), this->limbs.data(), an, b, bn);
+        }
+        else {
+            this->limbs.resize(bn, 0);
+            sub(this->limbs.data(), b, bn, this->limbs.data(), an);
+            this->negative = bNegative;
+        }
+
+        normalize();
+    }
+
+    void mulSmall(long long int m) {
+        Limb magnitude = m < 0 ? 0ULL - (Limb)m : (Limb)m;
+        Limb carry = mul1(this->limbs.data(), this->limbs.data(),
+                          this->limbs.size(), magnitude);
+        if (carry != 0) {
+            this->limbs.push_back(carry);
+        }
+        this->negative = this->negative != (m < 0);
+        normalize();
+    }
+
+    void divExactSmall(long long int d) {
+        Limb magnitude = d < 0 ? 0ULL - (Limb)d : (Limb)d;
+        divExact1(this->limbs.data(), this->limbs.data(), this->limbs.size(),
+                  magnitude);
+        this->negative = this->negative != (d < 0);
+        normalize();
+    }
+
+    // this += b * m for a small m.
+    void addMul(const SignedLimbs& b, long long int m) {
+        SignedLimbs t = b;
+        t.mulSmall(m);
+        add(t, false);
+    }
+
+    static SignedLimbs product(const SignedLimbs& a, const SignedLimbs& b) {
+        SignedLimbs p;
+        std::size_t an = a.limbs.size();
+        std::size_t bn = b.limbs.size();
+        if (an == 0 || bn == 0) {
+            return p;
+        }
+
+        p.limbs.resize(an + bn);
+        if (an >= bn) {
+            mul(p.limbs.data(), a.limbs.data(), an, b.limbs.data(), bn);
+        }
+        else {
+            mul(p.limbs.data(), b.limbs.data(), bn, a.limbs.data(), an);
+        }
+        p.negative = a.negative != b.negative;
+        p.normalize();
+        return p;
+    }
+};
+
+/*
+ * The pointwise products of a Toom-Cook step. They are independent, so they
+ * are collected first and then evaluated together, in parallel once the
+ * pieces are large enough.
+ */
+class PointwiseProducts {
+
+public:
+    void add(SignedLimbs& result, const SignedLimbs& a, const SignedLimbs& b) {
+        this->products.push_back(Entry{&result, &a, &b});
+    }
+
+    // Evaluates the products of pieces of k limbs.
+    void evaluate(std::size_t k) {
+        if (!forkable(k)) {
+            for (std::size_t i = 0; i < this->products.size(); i++) {
+                this->products[i].evaluate();
+            }
+            return;
+        }
+
+        TaskGroup tasks;
+        for (std::size_t i = 1; i < this->products.size(); i++) {
+            Entry& entry = this->products[i];
+            tasks.run([&entry] { entry.evaluate(); });
+        }
+        this->products[0].evaluate();
+        tasks.wait();
+    }
+
+private:
+    struct Entry {
+        SignedLimbs* result;
+        const SignedLimbs* a;
+        const SignedLimbs* b;
+
+        void evaluate() {
+            *this->result = SignedLimbs::product(*this->a, *this->b);
+        }
+    };
+
+    std::vector<Entry> products;
+};
+
+// Piece i of the k limb pieces of a, empty when a is too short.
+inline SignedLimbs toomPiece(const Limb* a, std::size_t an,
+                             std::size_t i, std::size_t k) {
+    std::size_t begin = std::min(i * k, an);
+    std::size_t end = std::min(begin + k, an);
+    return SignedLimbs(a + begin, end - begin);
+}
+
+// Values at 1 and -1 of the polynomial with coefficients p.
+inline void toomEvaluateOne(SignedLimbs& plus, SignedLimbs& minus,
+                            const std::vector<SignedLimbs>& p) {
+    SignedLimbs odd;
+    plus = SignedLimbs();
+    for (std::size_t i = 0; i < p.size(); i++) {
+        (i % 2 == 0 ? plus : odd).add(p[i], false);
+    }
+    minus = plus;
+    plus.add(odd, false);
+    minus.add(odd, true);
+}
+
+// Values at 2 and -2 of the polynomial with coefficients p.
+inline void toomEvaluateTwo(SignedLimbs& plus, SignedLimbs& minus,
+                            const std::vector<SignedLimbs>& p) {
+    SignedLimbs odd;
+    plus = SignedLimbs();
+    for (std::size_t i = p.size(); i-- > 0;) {
+        SignedLimbs& part = i % 2 == 0 ? plus : odd;
+        part.mulSmall(4);
+        part.add(p[i], false);
+    }
+    odd.mulSmall(2);
+    minus = plus;
+    plus.add(odd, false);
+    minus.add(odd, true);
+}
+
+// 2^(size - 1) times the value at 1/2 of the polynomial with coefficients p.
+inline SignedLimbs toomEvaluateHalf(const std::vector<SignedLimbs>& p) {
+    SignedLimbs value;
+    for (std::size_t i = 0; i < p.size(); i++) {
+        value.mulSmall(2);
+        value.add(p[i], false);
+    }
+    return value;
+}
+
+// r = sum c[j] B^(jk), r holds n limbs and every c[j] is non negative.
+inline void toomRecompose(Limb* r, std::size_t n,
+                          const std::vector<SignedLimbs>& c, std::size_t k) {
+    std::fill(r, r + n, 0);
+    for (std::size_t j = 0; j < c.size(); j++) {
+        std::size_t size = c[j].limbs.size();
+        if (size > 0) {
+            add(r + j * k, r + j * k, n - j * k, c[j].limbs.data(), size);
+        }
+    }
+}
+
+/*
+ * Toom-Cook multiplication. Both operands are cut into k limb pieces
+ * a(x) = sum a_i x^i, the product polynomial is evaluated at a handful of
+ * small points, multiplied pointwise through mul() and interpolated back.
+ * r holds an + bn limbs and must not overlap a or b.
+ */
+
+// Toom-3, 3x3 pieces, points 0, 1, -1, -2 and infinity (Bodrato's sequence).
+inline void mulToom33(Limb* r, const Limb* a, std::size_t an,
+                      const Limb* b, std::size_t bn) {
+    std::size_t k = (an + 2) / 3;
+    bool square = a == b && an == bn;
+
+    std::vector<SignedLimbs> p(3);
+    std::vector<SignedLimbs> q(3);
+    for (std::size_t i = 0; i < 3; i++) {
+        p[i] = toomPiece(a, an, i, k);
+        q[i] = toomPiece(b, square ? 0 : bn, i, k);
+    }
+
+    SignedLimbs p1, pm1, q1, qm1;
+    toomEvaluateOne(p1, pm1, p);
+    toomEvaluateOne(q1, qm1, q);
+
+    SignedLimbs pm2 = pm1;
+    pm2.add(p[2], false);
+    pm2.mulSmall(2);
+    pm2.add(p[0], true);
+    SignedLimbs qm2 = qm1;
+    qm2.add(q[2], false);
+    qm2.mulSmall(2);
+    qm2.add(q[0], true);
+
+    // Squares leave q empty and square the values of p through sqr().
+    std::vector<SignedLimbs> c(5);
+    SignedLimbs r1, rm1, rm2;
+    PointwiseProducts products;
+    products.add(c[0], p[0], square ? p[0] : q[0]);
+    products.add(r1, p1, square ? p1 : q1);
+    products.add(rm1, pm1, square ? pm1 : qm1);
+    products.add(rm2, pm2, square ? pm2 : qm2);
+    products.add(c[4], p[2], square ? p[2] : q[2]);
+    products.evaluate(k);
+
+    // r3 = (r(-2) - r(1)) / 3
+    SignedLimbs r3 = rm2;
+    r3.add(r1, true);
+    r3.divExactSmall(3);
+    // c1 + c3 = (r(1) - r(-1)) / 2
+    r1.add(rm1, true);
+    r1.divExactSmall(2);
+    // r2 = r(-1) - c0
+    c[2] = rm1;
+    c[2].add(c[0], true);
+    // c3 = (r2 - r3) / 2 + 2 c4
+    c[3] = c[2];
+    c[3].add(r3, true);
+    c[3].divExactSmall(2);
+    c[3].addMul(c[4], 2);
+    // c2 = r2 + c1 + c3 - c4
+    c[2].add(r1, false);
+    c[2].add(c[4], true);
+    // c1 = (c1 + c3) - c3
+    c[1] = r1;
+    c[1].add(c[3], true);
+
+    toomRecompose(r, an + bn, c, k);
+}
+
+/*
+ * Toom-4, 4x4 pieces, points 0, 1, -1, 2, -2, 1/2 and infinity. The even and
+ * odd coefficients are recovered separately from the symmetric points.
+ */
+inline void mulToom44(Limb* r, const Limb* a, std::size_t an,
+                      const Limb* b, std::size_t bn) {
+    std::size_t k = (an + 3) / 4;
+    bool square = a == b && an == bn;
+
+    std::vector<SignedLimbs> p(4);
+    std::vector<SignedLimbs> q(4);
+    for (std::size_t i = 0; i < 4; i++) {
+        p[i] = toomPiece(a, an, i, k);
+        q[i] = toomPiece(b, square ? 0 : bn, i, k);
+    }
+
+    SignedLimbs p1, pm1, p2, pm2, q1, qm1, q2, qm2;
+    toomEvaluateOne(p1, pm1, p);
+    toomEvaluateOne(q1, qm1, q);
+    toomEvaluateTwo(p2, pm2, p);
+    toomEvaluateTwo(q2, qm2, q);
+
+    SignedLimbs pHalf = toomEvaluateHalf(p);
+    SignedLimbs qHalf = toomEvaluateHalf(q);
+
+    // Squares leave q empty and square the values of p through sqr().
+    std::vector<SignedLimbs> c(7);
+    SignedLimbs e1, o1, e2, o2, h;
+    PointwiseProducts products;
+    products.add(c[0], p[0], square ? p[0] : q[0]);
+    products.add(e1, p1, square ? p1 : q1);
+    products.add(o1, pm1, square ? pm1 : qm1);
+    products.add(e2, p2, square ? p2 : q2);
+    products.add(o2, pm2, square ? pm2 : qm2);
+    products.add(h, pHalf, square ? pHalf : qHalf);
+    products.add(c[6], p[3], square ? p[3] : q[3]);
+    products.evaluate(k);
+
+    // Even and odd parts, o1 = c1 + c3 + c5 and o2 = c1 + 4 c3 + 16 c5
+    SignedLimbs t = o1;
+    o1 = e1;
+    o1.add(t, true);
+    o1.divExactSmall(2);
+    e1.add(o1, true);
+    t = o2;
+    o2 = e2;
+    o2.add(t, true);
+    o2.divExactSmall(4);
+    e2.addMul(o2, -2);
+
+    // c2 + c4 and c2 + 4 c4
+    e1.add(c[0], true);
+    e1.add(c[6], true);
+    e2.add(c[0], true);
+    e2.addMul(c[6], -64);
+    e2.divExactSmall(4);
+    c[4] = e2;
+    c[4].add(e1, true);
+    c[4].divExactSmall(3);
+    c[2] = e1;
+    c[2].add(c[4], true);
+
+    // h = 16 c1 + 4 c3 + c5
+    h.addMul(c[0], -64);
+    h.addMul(c[2], -16);
+    h.addMul(c[4], -4);
+    h.add(c[6], true);
+    h.divExactSmall(2);
+
+    // p = c3 + 5 c5, q = 5 c1 + c3
+    SignedLimbs pq = o2;
+    pq.add(o1, true);
+    pq.divExactSmall(3);
+    h.add(o1, true);
+    h.divExactSmall(3);
+
+    // c5 = (q + 4 p - 5 o1) / 15
+    c[5] = h;
+    c[5].addMul(pq, 4);
+    c[5].addMul(o1, -5);
+    c[5].divExactSmall(15);
+    c[3] = pq;
+    c[3].addMul(c[5], -5);
+    c[1] = o1;
+    c[1].add(c[3], true);
+    c[1].add(c[5], true);
+
+    toomRecompose(r, an + bn, c, k);
+}
+
+// Toom-32, 3x2 pieces, points 0, 1, -1 and infinity.
+inline void mulToom32(Limb* r, const Limb* a, std::size_t an,
+                      const Limb* b, std::size_t bn) {
+    std::size_t k = std::max((an + 2) / 3, (bn + 1) / 2);
+
+    std::vector<SignedLimbs> p(3);
+    std::vector<SignedLimbs> q(2);
+    for (std::size_t i = 0; i < 3; i++) {
+        p[i] = toomPiece(a, an, i, k);
+    }
+    for (std::size_t i = 0; i < 2; i++) {
+        q[i] = toomPiece(b, bn, i, k);
+    }
+
+    SignedLimbs p1, pm1, q1, qm1;
+    toomEvaluateOne(p1, pm1, p);
+    toomEvaluateOne(q1, qm1, q);
+
+    std::vector<SignedLimbs> c(4);
+    SignedLimbs r1, rm1;
+    PointwiseProducts products;
+    products.add(c[0], p[0], q[0]);
+    products.add(r1, p1, q1);
+    products.add(rm1, pm1, qm1);
+    products.add(c[3], p[2], q[1]);
+    products.evaluate(k);
+
+    // c1 + c3 = (r(1) - r(-1)) / 2 and c0 + c2 = r(1) - (c1 + c3)
+    c[1] = r1;
+    c[1].add(rm1, true);
+    c[1].divExactSmall(2);
+    c[2] = r1;
+    c[2].add(c[1], true);
+    c[2].add(c[0], true);
+    c[1].add(c[3], true);
+
+    toomRecompose(r, an + bn, c, k);
+}
+
+// Toom-42, 4x2 pieces, points 0, 1, -1, 2 and infinity.
+inline void mulToom42(Limb* r, const Limb* a, std::size_t an,
+                      const Limb* b, std::size_t bn) {
+    std::size_t k = std::max((an + 3) / 4, (bn + 1) / 2);
+
+    std::vector<SignedLimbs> p(4);
+    std::vector<SignedLimbs> q(2);
+    for (std::size_t i = 0; i < 4; i++) {
+        p[i] = toomPiece(a, an, i, k);
+    }
+    for (std::size_t i = 0; i < 2; i++) {
+        q[i] = toomPiece(b, bn, i, k);
+    }
+
+    SignedLimbs p1, pm1, p2, pm2, q1, qm1, q2, qm2;
+    toomEvaluateOne(p1, pm1, p);
+    toomEvaluateOne(q1, qm1, q);
+    toomEvaluateTwo(p2, pm2, p);
+    toomEvaluateTwo(q2, qm2, q);
+
+    std::vector<SignedLimbs> c(5);
+    SignedLimbs r1, rm1, r2;
+    PointwiseProducts products;
+    products.add(c[0], p[0], q[0]);
+    products.add(r1, p1, q1);
+    products.add(rm1, pm1, qm1);
+    products.add(r2, p2, q2);
+    products.add(c[4], p[3], q[1]);
+    products.evaluate(k);
+
+    // o = c1 + c3 and c2 = r(1) - o - c0 - c4
+    SignedLimbs o = r1;
+    o.add(rm1, true);
+    o.divExactSmall(2);
+    c[2] = r1;
+    c[2].add(o, true);
+    c[2].add(c[0], true);
+    c[2].add(c[4], true);
+
+    // (r(2) - c0 - 4 c2 - 16 c4) / 2 = c1 + 4 c3
+    r2.add(c[0], true);
+    r2.addMul(c[2], -4);
+    r2.addMul(c[4], -16);
+    r2.divExactSmall(2);
+    c[3] = r2;
+    c[3].add(o, true);
+    c[3].divExactSmall(3);
+    c[1] = o;
+    c[1].add(c[3], true);
+
+    toomRecompose(r, an + bn, c, k);
+}
+
+#ifndef BIGNUMERICS_NTT_THRESHOLD
+#define BIGNUMERICS_NTT_THRESHOLD 3000
+#endif
+
+/*
+ * From NTT_THRESHOLD limbs on, products are computed through number
+ * theoretic transforms modulo three primes and recombined with the Chinese
+ * remainder theorem.
+ */
+const std::size_t NTT_THRESHOLD = BIGNUMERICS_NTT_THRESHOLD;
+
+// Transforms up to this many points are done stage by stage in one block.
+const std::size_t NTT_BLOCK = 1 << 12;
+
+/*
+ * Arithmetic modulo a prime p = c 2^k + 1 < 2^62 in Montgomery
+ * representation, x is stored as x 2^64 mod p.
+ */
+struct NTTPrime {
+    Limb p;
+    Limb pInverse;
+    Limb r;
+    Limb r2;
+    Limb generator;
+
+    NTTPrime(Limb prime, Limb primitiveRoot) : p{prime},
+        pInverse{inverseModLimb(prime)},
+        r{(Limb)((((DoubleLimb)1) << LIMB_BITS) % prime)},
+        r2{(Limb)((DoubleLimb)r * r % prime)},
+        generator{primitiveRoot} {}
+
+    /*
+     * a b 2^-64 mod p. The corrections below are branch free, the operands
+     * are effectively random so a branch would mispredict half the time.
+     */
+    Limb mul(Limb a, Limb b) const {
+        DoubleLimb t = (DoubleLimb)a * b;
+        Limb m = (Limb)t * this->pInverse;
+        Limb tHigh = (Limb)(t >> LIMB_BITS);
+        Limb mpHigh = (Limb)(((DoubleLimb)m * this->p) >> LIMB_BITS);
+        Limb u = tHigh - mpHigh;
+        return u + (this->p & (0 - (Limb)(tHigh < mpHigh)));
+    }
+
+    Limb add(Limb a, Limb b) const {
+        Limb s = a + b - this->p;
+        return s + (this->p & (0 - (s >> (LIMB_BITS - 1))));
+    }
+
+    Limb sub(Limb a, Limb b) const {
+        Limb d = a - b;
+        return d + (this->p & (0 - (d >> (LIMB_BITS - 1))));
+    }
+
+    Limb toMontgomery(Limb a) const {
+        return mul(a % this->p, this->r2);
+    }
+
+    // Reduces a full limb into [0, p) without leaving Montgomery form.
+    Limb reduce(Limb a) const {
+        return mul(a, this->r);
+    }
+
+    Limb pow(Limb a, Limb e) const {
+        Limb result = this->r;
+        while (e != 0) {
+            if (e & 1) {
+                result = mul(result, a);
+            }
+            a = mul(a, a);
+            e >>= 1;
+        }
+        return result;
+    }
+
+    /*
+     * Fills w with the roots of unity used by a transform of length n, the
+     * n / 2 powers of the primitive length m root live at w[m / 2 + i].
+     */
+    void roots(std::vector<Limb>& w, std::size_t n, bool inverse) const {
+        w.resize(n);
+        if (n < 2) {
+            return;
+        }
+
+        Limb g = toMontgomery(this->generator);
+        Limb root = pow(g, (this->p - 1) / n);
+        if (inverse) {
+            root = pow(root, this->p - 2);
+        }
+
+        std::size_t h = n / 2;
+        parallelFor(0, h, [&](std::size_t begin, std::size_t end) {
+            Limb* powers = w.data() + h;
+            Limb step = root;
+            Limb x = pow(step, begin);
+            for (std::size_t i = begin; i < end; i++) {
+                powers[i] = x;
+                x = mul(x, step);
+            }
+        });
+        for (std::size_t m = h; m >= 2; m /= 2) {
+            parallelFor(0, m / 2, [&](std::size_t begin, std::size_t end) {
+                Limb* to = w.data() + m / 2;
+                const Limb* from = w.data() + m;
+                for (std::size_t i = begin; i < end; i++) {
+                    to[i] = from[2 * i];
+                }
+            });
+        }
+    }
+};
+
+inline const NTTPrime* nttPrimes() {
+    static const NTTPrime primes[3] = {
+        NTTPrime(4179340454199820289ULL, 3),
+        NTTPrime(2485986994308513793ULL, 5),
+        NTTPrime(1945555039024054273ULL, 5)
+    };
+    return primes;
+}
+
+/*
+ * Butterflies begin to end of the outermost stage of a transform of 2 h
+ * points, split off so that the parallel transforms can hand out ranges of
+ * them. When only the first size < h inputs may be non zero the upper half
+ * is just the lower one times the twiddles.
+ */
+inline void nttForwardStage(Limb* a, std::size_t h, std::size_t size,
+                            std::size_t begin, std::size_t end,
+                            const Limb* w, const NTTPrime& prime) {
+    if (size <= h) {
+        for (std::size_t i = begin; i < end; i++) {
+            a[i + h] = prime.mul(a[i], w[h + i]);
+        }
+        return;
+    }
+
+    for (std::size_t i = begin; i < end; i++) {
+        Limb u = a[i];
+        Limb v = a[i + h];
+        a[i] = prime.add(u, v);
+        a[i + h] = prime.mul(prime.sub(u, v), w[h + i]);
+    }
+}
+
+inline void nttInverseStage(Limb* a, std::size_t h,
+                            std::size_t begin, std::size_t end,
+                            const Limb* w, const NTTPrime& prime) {
+    for (std::size_t i = begin; i < end; i++) {
+        Limb u = a[i];
+        Limb v = prime.mul(a[i + h], w[h + i]);
+        a[i] = prime.add(u, v);
+        a[i + h] = prime.sub(u, v);
+    }
+}
+
+// a[i] = a[i] b[i] for i in [begin, end).
+inline void nttPointwise(Limb* a, const Limb* b,
+                         std::size_t begin, std::size_t end,
+                         const NTTPrime& prime) {
+    for (std::size_t i = begin; i < end; i++) {
+        a[i] = prime.mul(a[i], b[i]);
+    }
+}
+
+/*
+ * Decimation in frequency, natural order in and bit reversed order out.
+ * Only the first size inputs may be non zero, stages whose upper half is
+ * known to be zero degenerate into a twiddle multiplication (truncated
+ * input). Above NTT_BLOCK points one stage is done over the whole array
+ * before recursing on the halves so that the recursion ends on blocks that
+ * stay in cache.
+ */
+inline void nttForward(Limb* a, std::size_t n, std::size_t size,
+                       const Limb* w, const NTTPrime& prime) {
+    if (size == 0) {
+        return;
+    }
+
+    if (n <= NTT_BLOCK && size > n / 2) {
+        for (std::size_t m = n; m >= 2; m /= 2) {
+            std::size_t h = m / 2;
+            for (std::size_t s = 0; s < n; s += m) {
+                for (std::size_t i = 0; i < h; i++) {
+                    Limb u = a[s + i];
+                    Limb v = a[s + i + h];
+                    a[s + i] = prime.add(u, v);
+                    a[s + i + h] = prime.mul(prime.sub(u, v), w[h + i]);
+                }
+            }
+        }
+        return;
+    }
+
+    std::size_t h = n / 2;
+    parallelFor(0, std::min(size, h), [&](std::size_t begin, std::size_t end) {
+        nttForwardStage(a, h, size, begin, end, w, prime);
+    });
+
+    std::size_t half = std::min(size, h);
+    if (forkable(h)) {
+        TaskGroup tasks;
+        tasks.run([&] { nttForward(a + h, h, half, w, prime); });
+        nttForward(a, h, half, w, prime);
+        tasks.wait();
+    }
+    else {
+        nttForward(a, h, half, w, prime);
+        nttForward(a + h, h, half, w, prime);
+    }
+}
+
+// Decimation in time with inverse roots, bit reversed in and natural out.
+inline void nttInverse(Limb* a, std::size_t n, const Limb* w,
+                       const NTTPrime& prime) {
+    if (n <= NTT_BLOCK) {
+        for (std::size_t m = 2; m <= n; m *= 2) {
+            std::size_t h = m / 2;
+            for (std::size_t s = 0; s < n; s += m) {
+                for (std::size_t i = 0; i < h; i++) {
+                    Limb u = a[s + i];
+                    Limb v = prime.mul(a[s + i + h], w[h + i]);
+                    a[s + i] = prime.add(u, v);
+                    a[s + i + h] = prime.sub(u, v);
+                }
+            }
+        }
+        return;
+    }
+
+    std::size_t h = n / 2;
+    if (forkable(h)) {
+        TaskGroup tasks;
+        tasks.run([&] { nttInverse(a + h, h, w, prime); });
+        nttInverse(a, h, w, prime);
+        tasks.wait();
+    }
+    else {
+        nttInverse(a, h, w, prime);
+        nttInverse(a + h, h, w, prime);
+    }
+
+    parallelFor(0, h, [&](std::size_t begin, std::size_t end) {
+        nttInverseStage(a, h, begin, end, w, prime);
+    });
+}
+
+/*
+ * Cyclic convolution of a and b modulo one prime, the n point result is
+ * left in fa. When square is set b is ignored and the single forward
+ * transform of a is squared pointwise.
+ */
+inline void nttConvolution(std::vector<Limb>& fa, std::vector<Limb>& fb,
+                           const Limb* a, std::size_t an,
+                           const Limb* b, std::size_t bn,
+                           std::size_t n, bool square,
+                           const NTTPrime& prime) {
+    std::vector<Limb> w;
+    prime.roots(w, n, false);
+
+    auto transform = [&](std::vector<Limb>& f, const Limb* x, std::size_t xn) {
+        Limb* y = f.data();
+        std::fill(y + xn, y + n, 0);
+        parallelFor(0, xn, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; i++) {
+                y[i] = prime.reduce(x[i]);
+            }
+        });
+        nttForward(y, n, xn, w.data(), prime);
+    };
+
+    if (square) {
+        transform(fa, a, an);
+        parallelFor(0, n, [&](std::size_t begin, std::size_t end) {
+            nttPointwise(fa.data(), fa.data(), begin, end, prime);
+        });
+    }
+    else {
+        if (forkable(n)) {
+            TaskGroup tasks;
+            tasks.run([&] { transform(fb, b, bn); });
+            transform(fa, a, an);
+            tasks.wait();
+        }
+        else {
+            transform(fa, a, an);
+            transform(fb, b, bn);
+        }
+
+        parallelFor(0, n, [&](std::size_t begin, std::size_t end) {
+            nttPointwise(fa.data(), fb.data(), begin, end, prime);
+        });
+    }
+
+    prime.roots(w, n, true);
+    nttInverse(fa.data(), n, w.data(), prime);
+
+    // The inputs were plain residues, so every pointwise product lost a
+    // factor 2^64, fold it back in together with 1 / n.
+    Limb scale = prime.pow(prime.toMontgomery(n), prime.p - 2);
+    scale = prime.mul(scale, prime.r2);
+    parallelFor(0, n, [&](std::size_t begin, std::size_t end) {
+        Limb factor = scale;
+        Limb* x = fa.data();
+        for (std::size_t i = begin; i < end; i++) {
+            x[i] = prime.mul(x[i], factor);
+        }
+    });
+}
+
+/*
+ * Garner's reconstruction of the columns begin to end of a product from
+ * their residues modulo the three primes, the three limb value of every
+ * column replaces its residues.
+ */
+inline void nttReconstruct(Limb* y1, Limb* y2, Limb* y3,
+                           std::size_t begin, std::size_t end,
+                           const NTTPrime* primes) {
+    const NTTPrime& p1 = primes[0];
+    const NTTPrime& p2 = primes[1];
+    const NTTPrime& p3 = primes[2];
+
+    // Garner constants, in Montgomery form.
+    Limb p1InverseModP2 = p2.pow(p2.toMontgomery(p1.p), p2.p - 2);
+    Limb p1ModP3 = p3.toMontgomery(p1.p);
+    Limb p1p2InverseModP3 = p3.pow(p3.mul(p1ModP3, p3.toMontgomery(p2.p)),
+                                   p3.p - 2);
+    DoubleLimb p1p2 = (DoubleLimb)p1.p * p2.p;
+
+    for (std::size_t i = begin; i < end; i++) {
+        Limb x1 = y1[i];
+        Limb x2 = p2.mul(p2.sub(y2[i], x1 % p2.p), p1InverseModP2);
+        Limb x12ModP3 = p3.add(x1 % p3.p, p3.mul(x2 % p3.p, p1ModP3));
+        Limb x3 = p3.mul(p3.sub(y3[i], x12ModP3), p1p2InverseModP3);
+
+        // value = x1 + x2 p1 + x3 p1 p2
+        DoubleLimb low = (DoubleLimb)x2 * p1.p + x1;
+        DoubleLimb t = (DoubleLimb)x3 * (Limb)p1p2;
+        DoubleLimb high = (DoubleLimb)x3 * (Limb)(p1p2 >> LIMB_BITS) +
+            (Limb)(t >> LIMB_BITS);
+        DoubleLimb sum = (DoubleLimb)(Limb)low + (Limb)t;
+        y1[i] = (Limb)sum;
+        sum = (sum >> LIMB_BITS) + (Limb)(low >> LIMB_BITS) + (Limb)high;
+        y2[i] = (Limb)sum;
+        y3[i] = (Limb)(sum >> LIMB_BITS) + (Limb)(high >> LIMB_BITS);
+    }
+}
+
+/*
+ * r = a * b through three number theoretic transforms, r holds an + bn
+ * limbs and must not overlap a or b. Every limb is one coefficient, the
+ * convolution terms are below 2^128 min(an, bn) which the three primes
+ * (about 2^183 together) recover exactly by Garner's algorithm. Squares
+ * (a == b) only transform their operand once per prime.
+ */
+inline void mulNTT(Limb* r, const Limb* a, std::size_t an,
+                   const Limb* b, std::size_t bn) {
+    const NTTPrime* primes = nttPrimes();
+    bool square = a == b && an == bn;
+
+    std::size_t n = 1;
+    while (n < an + bn - 1) {
+        n *= 2;
+    }
+
+    // The three convolutions are independent, in parallel each of them
+    // needs its own buffer for the transform of b.
+    bool parallel = forkable(n);
+    std::vector<Limb> residues[3];
+    std::vector<Limb> fb[3];
+    auto convolve = [&](int k) {
+        std::vector<Limb>& f = fb[parallel ? k : 0];
+        f.resize(square ? 0 : n);
+        residues[k].resize(n);
+        nttConvolution(residues[k], f, a, an, b, bn, n, square, primes[k]);
+    };
+
+    if (parallel) {
+        TaskGroup tasks;
+        tasks.run([&] { convolve(1); });
+        tasks.run([&] { convolve(2); });
+        convolve(0);
+        tasks.wait();
+    }
+    else {
+        for (int k = 0; k < 3; k++) {
+            convolve(k);
+        }
+    }
+
+    // Each column is reconstructed in place of its residues and the carries
+    // between columns propagated after it. Serially this goes block by block
+    // while the columns are in cache, in parallel all blocks are
+    // reconstructed first.
+    std::size_t columns = an + bn - 1;
+    Limb carry[3] = {0, 0, 0};
+    auto propagate = [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; i++) {
+            Limb value[3] = {residues[0][i], residues[1][i], residues[2][i]};
+            Limb c = addN(value, value, carry, 3);
+            r[i] = value[0];
+            carry[0] = value[1];
+            carry[1] = value[2];
+            carry[2] = c;
+        }
+    };
+
+    if (forkable(columns)) {
+        parallelFor(0, columns, [&](std::size_t begin, std::size_t end) {
+            nttReconstruct(residues[0].data(), residues[1].data(),
+                           residues[2].data(), begin, end, primes);
+        });
+        propagate(0, columns);
+    }
+    else {
+        for (std::size_t begin = 0; begin < columns; begin += NTT_BLOCK) {
+            std::size_t end = std::min(begin + NTT_BLOCK, columns);
+            nttReconstruct(residues[0].data(), residues[1].data(),
+                           residues[2].data(), begin, end, primes);
+            propagate(begin, end);
+        }
+    }
+    r[columns] = carry[0];
+}
+
+/*
+ * r = a^2 for n >= 1, r holds 2n limbs and must not overlap a. Goes through
+ * the squaring variant of the algorithm mul() would pick: half the partial
+ * products in the schoolbook loop, one difference per Karatsuba level, one
+ * evaluation per point in Toom-Cook and one forward transform per prime in
+ * the NTT.
+ */
+inline void sqr(Limb* r, const Limb* a, std::size_t n) {
+    if (n < SQR_KARATSUBA_THRESHOLD) {
+        sqrBasecase(r, a, n);
+    }
+    else if (n >= NTT_THRESHOLD) {
+        mulNTT(r, a, n, a, n);
+    }
+    else if (n < TOOM3_THRESHOLD) {
+        std::vector<Limb> scratch(karatsubaScratchSize(n));
+        sqrKaratsuba(r, a, n, scratch.data());
+    }
+    else if (n < TOOM4_THRESHOLD) {
+        mulToom33(r, a, n, a, n);
+    }
+    else {
+        mulToom44(r, a, n, a, n);
+    }
+}
+
+/*
+ * r = a * b where an >= bn >= 1, r holds an + bn limbs and must not overlap
+ * a or b. Dispatches between the schoolbook loop, Karatsuba, Toom-Cook and
+ * the NTT on the size of the shorter operand, below the NTT operands more
+ * than three times longer than the other are cut into bn limb slices of a.
+ * Squares, a == b with an == bn, are handed to sqr().
+ */
+inline void mul(Limb* r, const Limb* a, std::size_t an,
+                const Limb* b, std::size_t bn) {
+    if (a == b && an == bn) {
+        sqr(r, a, an);
+    }
+    else if (bn < KARATSUBA_THRESHOLD) {
+        mulBasecase(r, a, an, b, bn);
+    }
+    else if (bn >= NTT_THRESHOLD) {
+        mulNTT(r, a, an, b, bn);
+    }
+    else if (an == bn && bn < TOOM3_THRESHOLD) {
+        std::vector<Limb> scratch(karatsubaScratchSize(bn));
+        mulKaratsuba(r, a, b, bn, scratch.data());
+    }
+    else if (an >= 3 * bn || bn < TOOM3_THRESHOLD) {
+        // In parallel every slice gets its own buffer and they are all
+        // multiplied before being added up.
+        std::size_t count = (an + bn - 1) / bn;
+        bool parallel = count > 1 && forkable(bn);
+        std::vector<Limb> slices(2 * bn * (parallel ? count : 1));
+        auto multiplySlice = [&](std::size_t j) {
+            Limb* slice = slices.data() + (parallel ? 2 * bn * j : 0);
+            std::size_t size = std::min(bn, an - j * bn);
+            if (size == bn) {
+                mul(slice, a + j * bn, bn, b, bn);
+            }
+            else {
+                mul(slice, b, bn, a + j * bn, size);
+            }
+        };
+
+        if (parallel) {
+            TaskGroup tasks;
+            for (std::size_t j = 1; j < count; j++) {
+                tasks.run([&multiplySlice, j] { multiplySlice(j); });
+            }
+            multiplySlice(0);
+            tasks.wait();
+        }
+
+        std::fill(r, r + an + bn, 0);
+        for (std::size_t j = 0; j < count; j++) {
+            if (!parallel) {
+                multiplySlice(j);
+            }
+            std::size_t i = j * bn;
+            std::size_t size = std::min(bn, an - i);
+            const Limb* slice = slices.data() + (parallel ? 2 * bn * j : 0);
+            add(r + i, r + i, an + bn - i, slice, size + bn);
+        }
+    }
+    else if (4 * an >= 7 * bn) {
+        mulToom42(r, a, an, b, bn);
+    }
+    else if (4 * an >= 5 * bn) {
+        mulToom32(r, a, an, b, bn);
+    }
+    else if (bn < TOOM4_THRESHOLD) {
+        mulToom33(r, a, an, b, bn);
+    }
+    else {
+        mulToom44(r, a, an, b, bn);
+    }
+}
+
+#ifndef BIGNUMERICS_BZ_THRESHOLD
+#define BIGNUMERICS_BZ_THRESHOLD 60
+#endif
+
+#ifndef BIGNUMERICS_NEWTON_DIVISION_THRESHOLD
+#define BIGNUMERICS_NEWTON_DIVISION_THRESHOLD 8000
+#endif
+
+/*
+ * Divisors with fewer limbs than BZ_THRESHOLD go through Algorithm D,
+ * larger ones through Burnikel-Ziegler recursive division. From
+ * NEWTON_DIVISION_THRESHOLD limbs on, a quotient spanning several divisor
+ * lengths amortizes a Newton reciprocal of the divisor instead. Both
+ * subquadratic algorithms get their speed from mul().
+ */
+const std::size_t BZ_THRESHOLD = BIGNUMERICS_BZ_THRESHOLD;
+const std::size_t NEWTON_DIVISION_THRESHOLD =
+    BIGNUMERICS_NEWTON_DIVISION_THRESHOLD;
+
+static_assert(BIGNUMERICS_BZ_THRESHOLD >= 2,
+              "the Burnikel-Ziegler threshold must be at least two limbs");
+
+/*
+ * q = u / v and r = u mod v by Algorithm D for un >= vn >= 1, v without
+ * leading zero limb. q holds un - vn + 1 limbs and r holds vn limbs, the
+ * normalized copies of u and v come from resource.
+ */
+inline void divRemBasecase(Limb* q, Limb* r, const Limb* u, std::size_t un,
+                           const Limb* v, std::size_t vn,
+                           MemoryResource* resource =
+                               defaultMemoryResource()) {
+    if (vn == 1) {
+        r[0] = divRem1(q, u, un, v[0]);
+        return;
+    }
+
+    // D1
+    unsigned s = countLeadingZeroes(v[vn - 1]);
+    LimbVector uNormalized(un + 1, resource);
+    LimbVector vNormalized(resource);
+
+    if (s > 0) {
+        vNormalized.resize(vn);
+        uNormalized[un] = lshift(uNormalized.data(), u, un, s);
+        lshift(vNormalized.data(), v, vn, s);
+        v = vNormalized.data();
+    }
+    else {
+        std::copy(u, u + un, uNormalized.data());
+    }
+
+    // D2-D7 run in place on uNormalized.
+    divideKnuth(q, uNormalized.data(), un, v, vn);
+
+    if (s > 0) {
+        rshift(r, uNormalized.data(), vn, s);
+    }
+    else {
+        std::copy(uNormalized.data(), uNormalized.data() + vn, r);
+    }
+}
+
+inline void divide3n2n(Limb* q, Limb* r, const Limb* a, const Limb* b,
+                       std::size_t h);
+
+/*
+ * Burnikel-Ziegler, q = a / b and r = a mod b where a holds 2n limbs, b is
+ * n limbs with its top bit set and a < b B^n. q and r hold n limbs each.
+ */
+inline void divide2n1n(Limb* q, Limb* r, const Limb* a, const Limb* b,
+                       std::size_t n) {
+    if (n % 2 == 1 || n < 2 * BZ_THRESHOLD) {
+        std::vector<Limb> u(a, a + 2 * n);
+        std::vector<Limb> quotient(n + 1);
+        u.push_back(0);
+        divideKnuth(quotient.data(), u.data(), 2 * n, b, n);
+        std::copy(quotient.begin(), quotient.begin() + n, q);
+        std::copy(u.begin(), u.begin() + n, r);
+        return;
+    }
+
+    std::size_t h = n / 2;
+    std::vector<Limb> z(3 * h);
+
+    divide3n2n(q + h, z.data() + h, a + h, b, h);
+    std::copy(a, a + h, z.begin());
+    divide3n2n(q, r, z.data(), b, h);
+}
+
+/*
+ * q = a / b and r = a mod b where a holds 3h limbs, b is 2h limbs with its
+ * top bit set and a < b B^h. q holds h limbs and r holds 2h limbs.
+ */
+inline void divide3n2n(Limb* q, Limb* r, const Limb* a, const Limb* b,
+                       std::size_t h) {
+    const Limb* a1 = a + 2 * h;
+    const Limb* b1 = b + h;
+
+    // r1 B^h + a3, one limb longer since r1 can reach b1 + B^h
+    std::vector<Limb> remainder(2 * h + 1);
+
+    if (cmp(a1, b1, h) < 0) {
+        divide2n1n(q, remainder.data() + h, a + h, b1, h);
+    }
+    else {
+        // a1 == b1 so the quotient estimate is B^h - 1 and
+        // r1 = (a1 B^h + a2) - (B^h - 1) b1 = a2 + b1
+        std::fill(q, q + h, ~(Limb)0);
+        remainder[2 * h] = addN(remainder.data() + h, a + h, b1, h);
+    }
+    std::copy(a, a + h, remainder.begin());
+
+    std::vector<Limb> d(2 * h);
+    mul(d.data(), q, h, b, h);
+
+    // At most two corrections, the estimate never falls short.
+    bool negative = sub(remainder.data(), remainder.data(), 2 * h + 1,
+                        d.data(), 2 * h) != 0;
+    while (negative) {
+        sub1(q, q, h, 1);
+        negative = add(remainder.data(), remainder.data(), 2 * h + 1,
+                       b, 2 * h) == 0;
+    }
+
+    std::copy(remainder.begin(), remainder.begin() + 2 * h, r);
+}
+
+inline void divRem(Limb* q, Limb* r, const Limb* u, std::size_t un,
+                   const Limb* v, std::size_t vn,
+                   MemoryResource* resource = defaultMemoryResource());
+
+/*
+ * inverse = floor((B^2n - 1) / v) for v of n limbs with its top bit set,
+ * inverse holds n + 1 limbs. The reciprocal of the top half of v is lifted
+ * by one Newton step x + x (B^2n - v x) / B^2n, which doubles its number
+ * of correct limbs, and the last few units are fixed up exactly.
+ */
+inline void reciprocal(Limb* inverse, const Limb* v, std::size_t n) {
+    if (n < NEWTON_DIVISION_THRESHOLD) {
+        std::vector<Limb> a(2 * n, ~(Limb)0);
+        std::vector<Limb> remainder(n);
+        divRem(inverse, remainder.data(), a.data(), 2 * n, v, n);
+        return;
+    }
+
+    std::size_t h = (n + 1) / 2;
+    std::vector<Limb> inverseHigh(h + 1);
+    reciprocal(inverseHigh.data(), v + n - h, h);
+
+    // x = inverseHigh B^(n - h), e = B^2n - v x
+    SignedLimbs e;
+    e.limbs.assign(2 * n + 1, 0);
+    e.limbs[2 * n] = 1;
+    SignedLimbs vx = SignedLimbs::product(SignedLimbs(v, n),
+        SignedLimbs(inverseHigh.data(), h + 1));
+    vx.limbs.insert(vx.limbs.begin(), n - h, 0);
+    e.add(vx, true);
+
+    // x' = x + x e / B^2n = (inverseHigh B^2n + inverseHigh e) / B^(n + h)
+    SignedLimbs x = SignedLimbs::product(
+        SignedLimbs(inverseHigh.data(), h + 1), e);
+    SignedLimbs lifted(inverseHigh.data(), h + 1);
+    lifted.limbs.insert(lifted.limbs.begin(), 2 * n, 0);
+    x.add(lifted, false);
+    if (x.limbs.size() > n + h) {
+        x.limbs.erase(x.limbs.begin(), x.limbs.begin() + (n + h));
+    }
+    else {
+        x = SignedLimbs();
+    }
+
+    // Exact correction against remainder = B^2n - 1 - v x'
+    SignedLimbs remainder;
+    remainder.limbs.assign(2 * n, ~(Limb)0);
+    remainder.add(SignedLimbs::product(SignedLimbs(v, n), x), true);
+
+    SignedLimbs divisor(v, n);
+    SignedLimbs one;
+    one.limbs.push_back(1);
+    while (remainder.negative) {
+        x.add(one, true);
+        remainder.add(divisor, false);
+    }
+    while (remainder.limbs.size() > n || (remainder.limbs.size() == n &&
+           cmp(remainder.limbs.data(), v, n) >= 0)) {
+        x.add(one, false);
+        remainder.add(divisor, true);
+    }
+
+    std::fill(inverse, inverse + n + 1, 0);
+    std::copy(x.limbs.begin(), x.limbs.end(), inverse);
+}
+
+/*
+ * q = a / b and r = a mod b with the precomputed reciprocal of b, where a
+ * holds 2n limbs, b is n limbs with its top bit set and a < b B^n. The
+ * estimate from the top n + 1 limbs of a is at most three units short.
+ */
+inline void divide2n1nNewton(Limb* q, Limb* r, const Limb* a, const Limb* b,
+                             const Limb* inverse, std::size_t n) {
+    std::vector<Limb> product(2 * n + 2);
+    mul(product.data(), a + n - 1, n + 1, inverse, n + 1);
+    std::copy(product.begin() + n + 1, product.begin() + 2 * n + 1, q);
+
+    std::vector<Limb> qb(2 * n);
+    std::vector<Limb> remainder(a, a + n + 1);
+    mul(qb.data(), q, n, b, n);
+    subN(remainder.data(), remainder.data(), qb.data(), n + 1);
+
+    while (remainder[n] != 0 || cmp(remainder.data(), b, n) >= 0) {
+        add1(q, q, n, 1);
+        remainder[n] -= subN(remainder.data(), remainder.data(), b, n);
+    }
+
+    std::copy(remainder.begin(), remainder.begin() + n, r);
+}
+
+/*
+ * Schoolbook division on blocks of n limbs, used by both subquadratic
+ * algorithms: the divisor is shifted until it fills n limbs with its top
+ * bit set and the dividend is consumed n limbs at a time, each step being
+ * a 2n by n division.
+ */
+inline void divRemBlocks(Limb* q, Limb* r, const Limb* u, std::size_t un,
+                         const Limb* v, std::size_t vn, bool newton) {
+    std::size_t n = vn;
+    if (!newton) {
+        // n = j 2^k with j below the threshold so that the recursion halves
+        // evenly down to the basecase.
+        std::size_t m = 1;
+        while (m * BZ_THRESHOLD <= vn) {
+            m *= 2;
+        }
+        n = (vn + m - 1) / m * m;
+    }
+
+    std::size_t limbShift = n - vn;
+    unsigned s = countLeadingZeroes(v[vn - 1]);
+
+    std::vector<Limb> b(n);
+    if (s > 0) {
+        lshift(b.data() + limbShift, v, vn, s);
+    }
+    else {
+        std::copy(v, v + vn, b.begin() + limbShift);
+    }
+
+    // Leave at least one spare bit at the top so that the first block is
+    // below b.
+    std::size_t an = un + limbShift + 1;
+    std::size_t t = std::max<std::size_t>(2, (an + n - 1) / n);
+    std::vector<Limb> a(t * n);
+    if (s > 0) {
+        a[un + limbShift] = lshift(a.data() + limbShift, u, un, s);
+    }
+    else {
+        std::copy(u, u + un, a.begin() + limbShift);
+    }
+
+    std::vector<Limb> inverse;
+    if (newton) {
+        inverse.resize(n + 1);
+        reciprocal(inverse.data(), b.data(), n);
+    }
+
+    std::vector<Limb> quotient((t - 1) * n);
+    std::vector<Limb> z(a.end() - 2 * n, a.end());
+    z.push_back(0);
+
+    for (std::size_t i = t - 1; i-- > 0;) {
+        // Steps with a short quotient, typically the first one, are cheaper
+        // through Algorithm D.
+        std::size_t zn = normalizedSize(z.data(), 2 * n);
+        if (zn < n + BZ_THRESHOLD) {
+            if (zn >= n) {
+                divideKnuth(quotient.data() + i * n, z.data(), zn, b.data(),
+                            n);
+            }
+            std::copy(z.begin(), z.begin() + n, z.begin() + n);
+            z[2 * n] = 0;
+        }
+        else if (newton) {
+            divide2n1nNewton(quotient.data() + i * n, z.data() + n, z.data(),
+                             b.data(), inverse.data(), n);
+        }
+        else {
+            divide2n1n(quotient.data() + i * n, z.data() + n, z.data(),
+                       b.data(), n);
+        }
+        if (i > 0) {
+            std::copy(a.begin() + (i - 1) * n, a.begin() + i * n, z.begin());
+        }
+    }
+
+    std::size_t qn = un - vn + 1;
+    std::fill(q, q + qn, 0);
+    std::copy(quotient.begin(),
+              quotient.begin() + std::min(qn, quotient.size()), q);
+
+    // The remainder is left shifted like the operands.
+    if (s > 0) {
+        rshift(r, z.data() + n + limbShift, vn, s);
+    }
+    else {
+        std::copy(z.begin() + n + limbShift, z.begin() + 2 * n, r);
+    }
+}
+
+/*
+ * q = u / v and r = u mod v for un >= vn >= 1, v without leading zero
+ * limb. q holds un - vn + 1 limbs and r holds vn limbs. Short divisions
+ * take their scratch limbs from resource.
+ */
+inline void divRem(Limb* q, Limb* r, const Limb* u, std::size_t un,
+                   const Limb* v, std::size_t vn, MemoryResource* resource) {
+    if (vn < BZ_THRESHOLD || un - vn < BZ_THRESHOLD) {
+        divRemBasecase(q, r, u, un, v, vn, resource);
+    }
+    else {
+        divRemBlocks(q, r, u, un, v, vn,
+                     vn >= NEWTON_DIVISION_THRESHOLD && un - vn >= 2 * vn);
+    }
+}
+
+#ifndef BIGNUMERICS_REDC_THRESHOLD
+#define BIGNUMERICS_REDC_THRESHOLD 100
+#endif
+
+/*
+ * Montgomery reduction by moduli shorter than REDC_THRESHOLD limbs goes limb
+ * by limb, longer moduli use two multiplications by a precomputed inverse
+ * modulo 2^(64 n) so that the reduction costs no more than the product.
+ */
+const std::size_t REDC_THRESHOLD = BIGNUMERICS_REDC_THRESHOLD;
+
+static_assert(BIGNUMERICS_REDC_THRESHOLD >= 1,
+              "the Montgomery reduction threshold must be at least one limb");
+
+// x = 1 / m mod 2^(64 n) for an odd m, by Newton iteration.
+inline void inverseModPower(Limb* x, const Limb* m, std::size_t n) {
+    std::fill(x, x + n, 0);
+    x[0] = inverseModLimb(m[0]);
+
+    // Every step doubles the limbs of x: with m x = 1 + 2^(64 k) e the next
+    // inverse is x - 2^(64 k) x e.
+    std::vector<Limb> e(2 * n);
+    std::vector<Limb> d(n);
+    for (std::size_t k = 1; k < n;) {
+        std::size_t next = std::min(2 * k, n);
+        mul(e.data(), m, next, x, k);
+        mul(d.data(), x, k, e.data() + k, next - k);
+        for (std::size_t i = 0; i < next - k; i++) {
+            x[k + i] = ~d[i];
+        }
+        add1(x + k, x + k, next - k, 1);
+        k = next;
+    }
+}
+
+/*
+ * r = t / 2^(64 n) mod m for a 2n limb t < m 2^(64 n), with mInverse =
+ * -1 / m[0] mod 2^64. Each step adds the multiple of m that clears the
+ * lowest limb of t and keeps its carry in that limb, the carries are added
+ * in one pass at the end. t is clobbered, r < m holds n limbs.
+ */
+inline void redcBasecase(Limb* r, Limb* t, const Limb* m, std::size_t n,
+                         Limb mInverse) {
+    for (std::size_t i = 0; i < n; i++) {
+        t[i] = addMul1(t + i, m, n, t[i] * mInverse);
+    }
+
+    if (addN(r, t + n, t, n) != 0 || cmp(r, m, n) >= 0) {
+        subN(r, r, m, n);
+    }
+}
+
+/*
+ * The same reduction with q = -t / m mod 2^(64 n) from the n limb
+ * mNegInverse = -1 / m mod 2^(64 n), r = (t + q m) / 2^(64 n). scratch
+ * holds 4n limbs.
+ */
+inline void redcMul(Limb* r, const Limb* t, const Limb* m, std::size_t n,
+                    const Limb* mNegInverse, Limb* scratch) {
+    Limb* q = scratch;
+    Limb* qm = scratch + 2 * n;
+    mul(q, t, n, mNegInverse, n);
+    mul(qm, q, n, m, n);
+
+    // The low halves of t and q m add up to 0 or 2^(64 n).
+    Limb carry = normalizedSize(t, n) != 0;
+    carry = add1(qm + n, qm + n, n, carry);
+    carry += addN(r, qm + n, t + n, n);
+    if (carry != 0 || cmp(r, m, n) >= 0) {
+        subN(r, r, m, n);
+    }
+}
+
+/*
+ * Bits per sliding window of a modular exponentiation by a bits long
+ * exponent, which balances the 2^(window - 1) precomputed odd powers
+ * against the multiplications they save.
+ */
+inline std::size_t powmodWindow(std::size_t bits) {
+    return bits <= 8 ? 1 : bits <= 24 ? 2 : bits <= 80 ? 3 : bits <= 240 ? 4 :
+        bits <= 672 ? 5 : bits <= 1792 ? 6 : 7;
+}
+
+#ifndef BIGNUMERICS_HGCD_THRESHOLD
+#define BIGNUMERICS_HGCD_THRESHOLD 500
+#endif
+
+/*
+ * Below HGCD_THRESHOLD limbs greatest common divisors are computed by
+ * Lehmer's method: single limb cofactors taken from the leading 128 bits of
+ * both operands reduce them by about a limb per pass. From HGCD_THRESHOLD
+ * limbs on, the half-GCD computes the cofactors of the leading limbs
+ * recursively and applies them with fast multiplications, which makes the
+ * GCD subquadratic.
+ */
+const std::size_t HGCD_THRESHOLD = BIGNUMERICS_HGCD_THRESHOLD;
+
+static_assert(BIGNUMERICS_HGCD_THRESHOLD >= 4,
+              "the half-GCD threshold must be at least four limbs");
+
+// Binary GCD of two limbs.
+inline Limb gcd1(Limb a, Limb b) {
+    if (a == 0 || b == 0) {
+        return a | b;
+    }
+
+    unsigned shift = __builtin_ctzll(a | b);
+    a >>= __builtin_ctzll(a);
+    while (b != 0) {
+        b >>= __builtin_ctzll(b);
+        if (a > b) {
+            std::swap(a, b);
+        }
+        b -= a;
+    }
+    return a << shift;
+}
+
+/*
+ * The GCD reduces pairs (a, b) by matrices M of determinant one with
+ * non-negative entries, (a; b) = M (a'; b'), that is a' = m11 a - m01 b and
+ * b' = m00 b - m10 a. Every step subtracts a multiple of the smaller number
+ * from the larger one, so gcd(a', b') = gcd(a, b).
+ */
+struct LimbMatrix {
+    Limb m00, m01, m10, m11;
+};
+
+/*
+ * Reduces the leading 128 bits x and y of two numbers while both stay at
+ * least 2^64. The entries then stay below 2^64 and below the reduced x and
+ * y, so the lower bits of the numbers cannot turn a reduced value negative
+ * and the matrix also reduces the whole numbers. Returns false when not a
+ * single step is possible.
+ */
+inline bool lehmerMatrix(DoubleLimb x, DoubleLimb y, LimbMatrix& k) {
+    const DoubleLimb limit = (DoubleLimb)1 << LIMB_BITS;
+    k = LimbMatrix{1, 0, 0, 1};
+    if (x < limit || y < limit) {
+        return false;
+    }
+
+    bool reduced = false;
+    for (;;) {
+        if (x >= y) {
+            if (x - y < limit) {
+                break;
+            }
+            DoubleLimb d = x - limit;
+            Limb q = d - y < y ? 1 : (Limb)(d / y);
+            x -= (DoubleLimb)q * y;
+            k.m01 += q * k.m00;
+            k.m11 += q * k.m10;
+        }
+        else {
+            if (y - x < limit) {
+                break;
+            }
+            DoubleLimb d = y - limit;
+            Limb q = d - x < x ? 1 : (Limb)(d / x);
+            y -= (DoubleLimb)q * x;
+            k.m00 += q * k.m01;
+            k.m10 += q * k.m11;
+        }
+        reduced = true;
+    }
+    return reduced;
+}
+
+// Euclid's algorithm on single limbs until x or y is zero.
+inline void euclid1(Limb& x, Limb& y, LimbMatrix& k) {
+    k = LimbMatrix{1, 0, 0, 1};
+    while (x != 0 && y != 0) {
+        if (x >= y) {
+            Limb q = x / y;
+            x -= q * y;
+            k.m01 += q * k.m00;
+            k.m11 += q * k.m10;
+        }
+        else {
+            Limb q = y / x;
+            y -= q * x;
+            k.m00 += q * k.m01;
+            k.m10 += q * k.m11;
+        }
+    }
+}
+
+/*
+ * The leading 128 bits of the larger of a and b, n >= 2 limbs, and the
+ * bits of the other one at the same position.
+ */
+inline void leadingBits(const Limb* a, const Limb* b, std::size_t n,
+                        DoubleLimb& x, DoubleLimb& y) {
+    unsigned shift = n > 2 ? countLeadingZeroes(a[n - 1] | b[n - 1]) : 0;
+    auto bits = [n, shift](const Limb* p) {
+        DoubleLimb v = ((DoubleLimb)p[n - 1] << LIMB_BITS) | p[n - 2];
+        return shift == 0 ? v :
+            (v << shift) | (p[n - 3] >> (LIMB_BITS - shift));
+    };
+    x = bits(a);
+    y = bits(b);
+}
+
+// (a, b) = (m11 a - m01 b, m00 b - m10 a) on n limbs, t holds 2n limbs.
+inline void lehmerApply(Limb* a, Limb* b, std::size_t n, const LimbMatrix& k,
+                        Limb* t) {
+    mul1(t, a, n, k.m11);
+    subMul1(t, b, n, k.m01);
+    mul1(t + n, b, n, k.m00);
+    subMul1(t + n, a, n, k.m10);
+    std::copy(t, t + n, a);
+    std::copy(t + n, t + 2 * n, b);
+}
+
+// x k for a single limb k.
+inline SignedLimbs scaled(const SignedLimbs& x, Limb k) {
+    SignedLimbs r;
+    r.limbs.resize(x.limbs.size() + 1);
+    r.limbs[x.limbs.size()] = mul1(r.limbs.data(), x.limbs.data(),
+                                   x.limbs.size(), k);
+    r.negative = x.negative;
+    r.normalize();
+    return r;
+}
+
+// x / B^k.
+inline SignedLimbs shifted(const SignedLimbs& x, std::size_t k) {
+    return x.limbs.size() > k ?
+        SignedLimbs(x.limbs.data() + k, x.limbs.size() - k) : SignedLimbs();
+}
+
+inline bool less(const SignedLimbs& a, const SignedLimbs& b) {
+    std::size_t an = a.limbs.size();
+    std::size_t bn = b.limbs.size();
+    return an != bn ? an < bn : cmp(a.limbs.data(), b.limbs.data(), an) < 0;
+}
+
+// The matrix of a reduction by multi-limb steps, see LimbMatrix.
+struct GcdMatrix {
+    SignedLimbs m[2][2];
+
+    GcdMatrix() {
+        this->m[0][0].limbs.push_back(1);
+        this->m[1][1].limbs.push_back(1);
+    }
+
+    // this = this k
+    void multiply(const LimbMatrix& k) {
+        for (int i = 0; i < 2; i++) {
+            SignedLimbs c0 = scaled(this->m[i][0], k.m00);
+            c0.add(scaled(this->m[i][1], k.m10), false);
+            SignedLimbs c1 = scaled(this->m[i][0], k.m01);
+            c1.add(scaled(this->m[i][1], k.m11), false);
+            this->m[i][0] = std::move(c0);
+            this->m[i][1] = std::move(c1);
+        }
+    }
+
+    void multiply(const GcdMatrix& k) {
+        for (int i = 0; i < 2; i++) {
+            SignedLimbs c[2];
+            for (int j = 0; j < 2; j++) {
+                c[j] = SignedLimbs::product(this->m[i][0], k.m[0][j]);
+                c[j].add(SignedLimbs::product(this->m[i][1], k.m[1][j]),
+                         false);
+            }
+            this->m[i][0] = std::move(c[0]);
+            this->m[i][1] = std::move(c[1]);
+        }
+    }
+
+    // this = this (1 q; 0 1) for column 1, this (1 0; q 1) for column 0.
+    void addColumn(int column, const SignedLimbs& q) {
+        for (int i = 0; i < 2; i++) {
+            this->m[i][column].add(
+                SignedLimbs::product(this->m[i][1 - column], q), false);
+        }
+    }
+
+    // (a, b) = (m11 a - m01 b, m00 b - m10 a), for cofactors of any sign.
+    void applyInverse(SignedLimbs& a, SignedLimbs& b) const {
+        SignedLimbs a1 = SignedLimbs::product(this->m[1][1], a);
+        a1.add(SignedLimbs::product(this->m[0][1], b), true);
+        SignedLimbs b1 = SignedLimbs::product(this->m[0][0], b);
+        b1.add(SignedLimbs::product(this->m[1][0], a), true);
+        a = std::move(a1);
+        b = std::move(b1);
+    }
+};
+
+// (u0, u1) = (m11 u0 - m01 u1, m00 u1 - m10 u0).
+inline void applyInverse(const LimbMatrix& k, SignedLimbs& u0,
+                         SignedLimbs& u1) {
+    SignedLimbs v0 = scaled(u0, k.m11);
+    v0.add(scaled(u1, k.m01), true);
+    SignedLimbs v1 = scaled(u1, k.m00);
+    v1.add(scaled(u0, k.m10), true);
+    u0 = std::move(v0);
+    u1 = std::move(v1);
+}
+
+/*
+ * One step of Lehmer's method on a and b, n >= 2 limbs for the larger one,
+ * t holds 2n limbs. Returns false when the leading bits allow no step.
+ */
+inline bool lehmerStep(SignedLimbs& a, SignedLimbs& b, LimbMatrix& k,
+                       std::vector<Limb>& t) {
+    std::size_t n = std::max(a.limbs.size(), b.limbs.size());
+    a.limbs.resize(n);
+    b.limbs.resize(n);
+
+    DoubleLimb x;
+    DoubleLimb y;
+    leadingBits(a.limbs.data(), b.limbs.data(), n, x, y);
+    bool reduced = lehmerMatrix(x, y, k);
+    if (reduced) {
+        t.resize(2 * n);
+        lehmerApply(a.limbs.data(), b.limbs.data(), n, k, t.data());
+    }
+
+    a.normalize();
+    b.normalize();
+    return reduced;
+}
+
+// q = a / b and a = a mod b for b > 0.
+inline void divideStep(SignedLimbs& a, const SignedLimbs& b, SignedLimbs& q) {
+    std::size_t an = a.limbs.size();
+    std::size_t bn = b.limbs.size();
+    if (an < bn) {
+        q = SignedLimbs();
+        return;
+    }
+
+    std::vector<Limb> r(bn);
+    q.limbs.resize(an - bn + 1);
+    divRem(q.limbs.data(), r.data(), a.limbs.data(), an, b.limbs.data(), bn);
+    a.limbs.swap(r);
+    a.normalize();
+    q.normalize();
+}
+
+inline bool hgcd(SignedLimbs& a, SignedLimbs& b, GcdMatrix& m);
+
+/*
+ * Reduces a and b by the half-GCD of their limbs from k on, which m
+ * receives. The leading limbs are reduced recursively and the lower limbs
+ * by the matrix of that reduction.
+ */
+inline bool hgcdLeading(SignedLimbs& a, SignedLimbs& b, std::size_t k,
+                        GcdMatrix& m) {
+    SignedLimbs aHigh = shifted(a, k);
+    SignedLimbs bHigh = shifted(b, k);
+    if (!hgcd(aHigh, bHigh, m)) {
+        return false;
+    }
+
+    a.limbs.resize(std::min(a.limbs.size(), k));
+    b.limbs.resize(std::min(b.limbs.size(), k));
+    a.normalize();
+    b.normalize();
+    m.applyInverse(a, b);
+
+    aHigh.limbs.insert(aHigh.limbs.begin(), k, 0);
+    bHigh.limbs.insert(bHigh.limbs.begin(), k, 0);
+    a.add(aHigh, false);
+    b.add(bHigh, false);
+    return true;
+}
+
+/*
+ * A step of the half-GCD that keeps both a and b at least B^s: a Lehmer
+ * step while the larger one has s + 3 limbs or more, otherwise the
+ * subtraction of the largest multiple of the smaller one that leaves the
+ * larger one at least B^s.
+ */
+inline bool hgcdStep(SignedLimbs& a, SignedLimbs& b, std::size_t s,
+                     GcdMatrix& m, std::vector<Limb>& t) {
+    LimbMatrix k;
+    if (std::max(a.limbs.size(), b.limbs.size()) >= s + 3 &&
+        lehmerStep(a, b, k, t)) {
+        m.multiply(k);
+        return true;
+    }
+
+    bool aLarger = !less(a, b);
+    SignedLimbs& x = aLarger ? a : b;
+    const SignedLimbs& y = aLarger ? b : a;
+
+    SignedLimbs power;
+    power.limbs.assign(s + 1, 0);
+    power.limbs[s] = 1;
+    SignedLimbs d = x;
+    d.add(y, true);
+    if (less(d, power)) {
+        return false;
+    }
+
+    // x = B^s + (x - B^s) mod y
+    SignedLimbs q;
+    x.add(power, true);
+    divideStep(x, y, q);
+    x.add(power, false);
+    m.addColumn(aLarger ? 1 : 0, q);
+    return true;
+}
+
+/*
+ * The half-GCD of a and b: with n the limbs of the larger one, reduces both
+ * by a matrix m while keeping them at least B^s, s = n / 2 + 1. The
+ * entries of m are then smaller than B^(n - s) and so smaller than a and b,
+ * which makes m reduce any numbers led by a and b as well. Returns false,
+ * leaving a and b alone, when no reduction is possible.
+ *
+ * Above HGCD_THRESHOLD the leading ceil(n / 2) limbs are reduced first,
+ * which leaves both numbers above B^s and about 3n / 4 limbs long, then
+ * the leading limbs of the result from 2s - n' on, n' its length.
+ */
+inline bool hgcd(SignedLimbs& a, SignedLimbs& b, GcdMatrix& m) {
+    std::size_t n = std::max(a.limbs.size(), b.limbs.size());
+    std::size_t s = n / 2 + 1;
+    m = GcdMatrix();
+    if (std::min(a.limbs.size(), b.limbs.size()) <= s) {
+        return false;
+    }
+
+    bool reduced = false;
+    if (n >= HGCD_THRESHOLD) {
+        reduced = hgcdLeading(a, b, n / 2, m);
+
+        std::size_t size = std::max(a.limbs.size(), b.limbs.size());
+        GcdMatrix m2;
+        if (size > s + 2 && hgcdLeading(a, b, 2 * s - size, m2)) {
+            m.multiply(m2);
+            reduced = true;
+        }
+    }
+
+    std::vector<Limb> t;
+    while (hgcdStep(a, b, s, m, t)) {
+        reduced = true;
+    }
+    return reduced;
+}
+
+/*
+ * Reduces a to gcd(a, b) and b to zero. With u, u[0] and u[1] follow the
+ * cofactors of a and b: when a = u[0] a0 mod b0 and b = u[1] a0 mod b0
+ * for the initial a0 and b0 on entry, this still holds on return.
+ */
+inline void gcdReduce(SignedLimbs& a, SignedLimbs& b, SignedLimbs* u) {
+    std::vector<Limb> t;
+    for (;;) {
+        if (less(a, b)) {
+            std::swap(a, b);
+            if (u != nullptr) {
+                std::swap(u[0], u[1]);
+            }
+        }
+
+        std::size_t n = a.limbs.size();
+        std::size_t bn = b.limbs.size();
+        if (bn == 0) {
+            return;
+        }
+
+        // Single limbs end with one matrix for all of Euclid's steps.
+        if (n == 1) {
+            Limb x = a.limbs[0];
+            Limb y = b.limbs[0];
+            LimbMatrix k;
+            if (u == nullptr) {
+                x = gcd1(x, y);
+                y = 0;
+            }
+            else {
+                euclid1(x, y, k);
+                applyInverse(k, u[0], u[1]);
+                if (x == 0) {
+                    std::swap(u[0], u[1]);
+                }
+            }
+            a.limbs[0] = x | y;
+            b = SignedLimbs();
+            return;
+        }
+
+        // The half-GCD of the leading two thirds of the limbs leaves a and
+        // b about n / 3 limbs shorter.
+        GcdMatrix m;
+        if (n >= HGCD_THRESHOLD && bn + 1 >= n &&
+            hgcdLeading(a, b, n / 3, m)) {
+            if (u != nullptr) {
+                m.applyInverse(u[0], u[1]);
+            }
+            continue;
+        }
+
+        LimbMatrix k;
+        if (bn + 1 >= n && lehmerStep(a, b, k, t)) {
+            if (u != nullptr) {
+                applyInverse(k, u[0], u[1]);
+            }
+            continue;
+        }
+
+        SignedLimbs q;
+        divideStep(a, b, q);
+        if (u != nullptr) {
+            u[0].add(SignedLimbs::product(q, u[1]), true);
+        }
+    }
+}
+
+// floor(sqrt(a)).
+inline Limb sqrt1(Limb a) {
+    // The rounded double root can be a unit off either way.
+    Limb r = (Limb)std::sqrt((double)a);
+    while ((DoubleLimb)r * r > a) {
+        r--;
+    }
+    while ((DoubleLimb)(r + 1) * (r + 1) <= a) {
+        r++;
+    }
+    return r;
+}
+
+#ifndef BIGNUMERICS_DECIMAL_CONVERSION_THRESHOLD
+#define BIGNUMERICS_DECIMAL_CONVERSION_THRESHOLD 30
+#endif
+
+/*
+ * Decimal strings are converted 19 digits at a time up to
+ * DECIMAL_CONVERSION_THRESHOLD limbs. Above it they are split recursively
+ * at powers 10^(19 2^k) from a power tree built once per conversion, so
+ * that parsing costs a few multiplications and printing a few divisions.
+ */
+const std::size_t DECIMAL_CONVERSION_THRESHOLD =
+    BIGNUMERICS_DECIMAL_CONVERSION_THRESHOLD;
+const Limb DECIMAL_CHUNK_BASE = 10000000000000000000ULL;
+const std::size_t DECIMAL_CHUNK_DIGITS = 19;
+
+static_assert(BIGNUMERICS_DECIMAL_CONVERSION_THRESHOLD >= 1,
+              "the decimal conversion threshold must be at least one limb");
+
+typedef std::vector<std::vector<Limb>> PowerTree;
+
+// powers[k] = 10^(19 2^k) for every k with 19 2^k < digits.
+inline PowerTree decimalPowers(std::size_t digits) {
+    PowerTree powers;
+    powers.push_back(std::vector<Limb>(1, DECIMAL_CHUNK_BASE));
+
+    while ((DECIMAL_CHUNK_DIGITS << powers.size()) < digits) {
+        const std::vector<Limb>& p = powers.back();
+        std::vector<Limb> square(2 * p.size());
+        mul(square.data(), p.data(), p.size(), p.data(), p.size());
+        square.resize(normalizedSize(square.data(), square.size()));
+        powers.push_back(std::move(square));
+    }
+
+    return powers;
+}
+
+inline void parseDecimalBasecase(std::vector<Limb>& r, const char* digits,
+                                 std::size_t size) {
+    r.clear();
+
+    std::size_t first = size % DECIMAL_CHUNK_DIGITS;
+    if (first == 0) {
+        first = DECIMAL_CHUNK_DIGITS;
+    }
+
+    for (std::size_t i = 0; i < size;) {
+        std::size_t chunkSize = i == 0 ? std::min(first, size) :
+            DECIMAL_CHUNK_DIGITS;
+
+        Limb chunk = 0;
+        for (std::size_t k = 0; k < chunkSize; k++) {
+            chunk = chunk * 10 + (Limb)(digits[i + k] - '0');
+        }
+        i += chunkSize;
+
+        Limb multiplier = i == chunkSize ? 1 : DECIMAL_CHUNK_BASE;
+        Limb carry = mul1(r.data(), r.data(), r.size(), multiplier);
+        if (carry != 0) {
+            r.push_back(carry);
+        }
+        carry = add1(r.data(), r.data(), r.size(), chunk);
+        if (carry != 0) {
+            r.push_back(carry);
+        }
+    }
+
+    r.resize(normalizedSize(r.data(), r.size()));
+}
+
+// r = the value of size decimal digits, split as high 10^(19 2^k) + low.
+inline void parseDecimal(std::vector<Limb>& r, const char* digits,
+                         std::size_t size, const PowerTree& powers) {
+    if (size <= DECIMAL_CONVERSION_THRESHOLD * DECIMAL_CHUNK_DIGITS) {
+        parseDecimalBasecase(r, digits, size);
+        return;
+    }
+
+    std::size_t k = powers.size() - 1;
+    while ((DECIMAL_CHUNK_DIGITS << k) >= size) {
+        k--;
+    }
+    std::size_t lowDigits = DECIMAL_CHUNK_DIGITS << k;
+    const std::vector<Limb>& p = powers[k];
+
+    std::vector<Limb> high;
+    std::vector<Limb> low;
+    parseDecimal(high, digits, size - lowDigits, powers);
+    parseDecimal(low, digits + size - lowDigits, lowDigits, powers);
+
+    if (high.empty()) {
+        r.swap(low);
+        return;
+    }
+
+    r.assign(high.size() + p.size(), 0);
+    if (high.size() >= p.size()) {
+        mul(r.data(), high.data(), high.size(), p.data(), p.size());
+    }
+    else {
+        mul(r.data(), p.data(), p.size(), high.data(), high.size());
+    }
+    add(r.data(), r.data(), r.size(), low.data(), low.size());
+    r.resize(normalizedSize(r.data(), r.size()));
+}
+
+inline void parseDecimal(std::vector<Limb>& r, const char* digits,
+                         std::size_t size) {
+    if (size <= DECIMAL_CONVERSION_THRESHOLD * DECIMAL_CHUNK_DIGITS) {
+        parseDecimalBasecase(r, digits, size);
+    }
+    else {
+        parseDecimal(r, digits, size, decimalPowers(size));
+    }
+}
+
+// Writes exactly width digits of a < 10^width, padded with leading zeroes.
+inline void writeDecimalBasecase(char* out, std::size_t width, const Limb* a,
+                                 std::size_t n) {
+    std::vector<Limb> t(a, a + n);
+    char* p = out + width;
+
+    while (n > 0) {
+        Limb chunk = divRem1(t.data(), t.data(), n, DECIMAL_CHUNK_BASE);
+        n = normalizedSize(t.data(), n);
+        for (std::size_t i = 0; i < DECIMAL_CHUNK_DIGITS && p > out; i++) {
+            *--p = (char)('0' + chunk % 10);
+            chunk /= 10;
+        }
+    }
+
+    std::fill(out, p, '0');
+}
+
+inline void writeDecimal(char* out, std::size_t width, const Limb* a,
+                         std::size_t n, const PowerTree& powers) {
+    n = normalizedSize(a, n);
+    if (n <= DECIMAL_CONVERSION_THRESHOLD) {
+        writeDecimalBasecase(out, width, a, n);
+        return;
+    }
+
+    std::size_t k = powers.size() - 1;
+    while ((DECIMAL_CHUNK_DIGITS << k) >= width) {
+        k--;
+    }
+    std::size_t lowDigits = DECIMAL_CHUNK_DIGITS << k;
+    const std::vector<Limb>& p = powers[k];
+
+    if (n < p.size() || (n == p.size() && cmp(a, p.data(), n) < 0)) {
+        std::fill(out, out + width - lowDigits, '0');
+        writeDecimal(out + width - lowDigits, lowDigits, a, n, powers);
+        return;
+    }
+
+    std::vector<Limb> q(n - p.size() + 1);
+    std::vector<Limb> r(p.size());
+    divRem(q.data(), r.data(), a, n, p.data(), p.size());
+
+    writeDecimal(out, width - lowDigits, q.data(), q.size(), powers);
+    writeDecimal(out + width - lowDigits, lowDigits, r.data(), r.size(),
+                 powers);
+}
+
+// The decimal digits of a, without leading zeroes.
+inline std::string toDecimal(const Limb* a, std::size_t n) {
+    // log10(2^64) < 19.266
+    std::size_t width = n * 19266 / 1000 + 1;
+    std::string s(width, '0');
+
+    if (n <= DECIMAL_CONVERSION_THRESHOLD) {
+        writeDecimalBasecase(&s[0], width, a, n);
+    }
+    else {
+        writeDecimal(&s[0], width, a, n, decimalPowers(width));
+    }
+
+    std::size_t leadingZeroes = std::min(s.find_first_not_of('0'),
+                                         width - 1);
+    return s.substr(leadingZeroes);
+}
+
+/*
+ * Sum of many magnitudes with deferred carries. Every limb position keeps
+ * its low limb and the number of carries out of it, so adding a magnitude
+ * is a loop without a carry chain and the carries are added back only once
+ * by normalize().
+ */
+class CarrySaveSum {
+
+public:
+    void add(const Limb* a, std::size_t n) {
+        if (n > this->low.size()) {
+            this->low.resize(n, 0);
+            this->carries.resize(n, 0);
+        }
+
+        Limb* low = this->low.data();
+        Limb* carries = this->carries.data();
+#ifdef BIGNUMERICS_HAS_X86_SIMD
+        if (n >= 8 && cpuFeatures().avx512) {
+            addCarrySaveAvx512(low, carries, a, n);
+            return;
+        }
+#endif
+        for (std::size_t i = 0; i < n; i++) {
+            Limb s = low[i] + a[i];
+            carries[i] += s < a[i];
+            low[i] = s;
+        }
+    }
+
+    void add(const CarrySaveSum& other) {
+        add(other.low.data(), other.low.size());
+
+        Limb* carries = this->carries.data();
+        for (std::size_t i = 0; i < other.carries.size(); i++) {
+            carries[i] += other.carries[i];
+        }
+    }
+
+    // r = the sum, without leading zero limbs.
+    void normalize(LimbVector& r) const {
+        std::size_t n = this->low.size();
+        r.assign(this->low.data(), n);
+        r.resize(n + 2);
+        if (n > 0) {
+            detail::add(r.data() + 1, r.data() + 1, n + 1,
+                        this->carries.data(), n);
+        }
+        r.resize(normalizedSize(r.data(), n + 2));
+    }
+
+private:
+    std::vector<Limb> low;
+    std::vector<Limb> carries;
+};
+
+/*
+ * Binary records of BigInteger::serialize() and BigDecimal::serialize(),
+ * every field little-endian whatever the host:
+ *
+ *   byte 0       format version, SERIAL_VERSION
+ *   byte 1       flags, SERIAL_NEGATIVE and SERIAL_DECIMAL
+ *   bytes 2-7    zero
+ *   bytes 8-15   limb count n
+ *   bytes 16-23  scale in two's complement, BigDecimal records only
+ *   then         n limbs of 8 bytes, least significant first
+ *
+ * The top limb is non zero and zero is never negative, so every value has
+ * a single record. Headers take a multiple of 8 bytes: records packed into
+ * an 8-byte aligned buffer keep their limbs aligned, which lets a
+ * BigIntegerView use them in place.
+ */
+const unsigned char SERIAL_VERSION = 1;
+const unsigned char SERIAL_NEGATIVE = 1;
+const unsigned char SERIAL_DECIMAL = 2;
+const std::size_t SERIAL_HEADER_SIZE = 16;
+
+inline void storeLittleEndian(unsigned char* p, std::uint64_t x) {
+    for (int i = 0; i < 8; i++) {
+        p[i] = (unsigned char)(x >> (8 * i));
+    }
+}
+
+inline std::uint64_t loadLittleEndian(const unsigned char* p) {
+    std::uint64_t x = 0;
+    for (int i = 0; i < 8; i++) {
+        x |= (std::uint64_t)p[i] << (8 * i);
+    }
+    return x;
+}
+
+// Appends the record of a n limb magnitude to out.
+inline void serializeRecord(std::vector<unsigned char>& out, const Limb* a,
+                            std::size_t n, bool negative, bool decimal,
+                            std::int64_t scale) {
+    std::size_t header = SERIAL_HEADER_SIZE + (decimal ? 8 : 0);
+    std::size_t offset = out.size();
+    out.resize(offset + header + n * sizeof(Limb), 0);
+
+    unsigned char* p = out.data() + offset;
+    p[0] = SERIAL_VERSION;
+    p[1] = (unsigned char)((negative ? SERIAL_NEGATIVE : 0) |
+                           (decimal ? SERIAL_DECIMAL : 0));
+    storeLittleEndian(p + 8, n);
+    if (decimal) {
+        storeLittleEndian(p + 16, (std::uint64_t)scale);
+    }
+
+    p += header;
+#ifdef BIGNUMERICS_LITTLE_ENDIAN
+    if (n > 0) {
+        std::memcpy(p, a, n * sizeof(Limb));
+    }
+#else
+    for (std::size_t i = 0; i < n; i++) {
+        storeLittleEndian(p + i * sizeof(Limb), a[i]);
+    }
+#endif
+}
+
+// The fields of a record read by readSerialRecord().
+struct SerialRecord {
+    const unsigned char* limbs;
+    std::size_t n;
+    bool negative;
+    bool decimal;
+    std::int64_t scale;
+    // Bytes taken by the whole record.
+    std::size_t size;
+};
+
+/*
+ * Reads the record at the start of the size bytes of data, throws
+ * std::invalid_argument naming type when it is truncated or malformed.
+ */
+inline SerialRecord readSerialRecord(const unsigned char* data,
+                                     std::size_t size, const char* type) {
+    std::string prefix = std::string(type) + ": ";
+    if (size < SERIAL_HEADER_SIZE) {
+        throw std::invalid_argument(prefix + "truncated record");
+    }
+    if (data[0] != SERIAL_VERSION) {
+        throw std::invalid_argument(prefix + "unsupported record version");
+    }
+
+    SerialRecord record = SerialRecord();
+    unsigned char flags = data[1];
+    bool reserved = (flags & ~(SERIAL_NEGATIVE | SERIAL_DECIMAL)) != 0;
+    for (int i = 2; i < 8; i++) {
+        reserved = reserved || data[i] != 0;
+    }
+    if (reserved) {
+        throw std::invalid_argument(prefix + "malformed record");
+    }
+    record.negative = (flags & SERIAL_NEGATIVE) != 0;
+    record.decimal = (flags & SERIAL_DECIMAL) != 0;
+
+    std::size_t header = SERIAL_HEADER_SIZE + (record.decimal ? 8 : 0);
+    if (size < header) {
+        throw std::invalid_argument(prefix + "truncated record");
+    }
+    std::uint64_t n = loadLittleEndian(data + 8);
+    if (n > (size - header) / sizeof(Limb)) {
+        throw std::invalid_argument(prefix + "truncated record");
+    }
+    if (record.decimal) {
+        record.scale = (std::int64_t)loadLittleEndian(data + 16);
+    }
+
+    record.limbs = data + header;
+    record.n = (std::size_t)n;
+    record.size = header + record.n * sizeof(Limb);
+    if ((record.n == 0 && record.negative) ||
+        (record.n > 0 && loadLittleEndian(record.limbs + (record.n - 1) *
+                                          sizeof(Limb)) == 0)) {
+        throw std::invalid_argument(prefix + "malformed record");
+    }
+    return record;
+}
+
+// r = the n limbs stored in a record.
+inline void loadLimbs(Limb* r, const unsigned char* p, std::size_t n) {
+#ifdef BIGNUMERICS_LITTLE_ENDIAN
+    if (n > 0) {
+        std::memcpy(r, p, n * sizeof(Limb));
+    }
+#else
+    for (std::size_t i = 0; i < n; i++) {
+        r[i] = loadLittleEndian(p + i * sizeof(Limb));
+    }
+#endif
+}
+
+} /* namespace detail */
+
+class BigIntegerView;
+
+class BigInteger {
+
+public:
+    typedef detail::Limb Limb;
+
+    BigInteger(std::string n) : limbs{} {
+        bool isNegative = false;
+        if (n.size() > 0 && (n[0] == '-' || n[0] == '+')) {
+            isNegative = n[0] == '-';
+            n.erase(0, 1);
+        }
+
+        for (size_t i = 0; i < n.size(); i++) {
+            if (n[i] < '0' || n[i] > '9') {
+                throw std::invalid_argument("BigInteger: invalid digit in \"" +
+                                            n + "\"");
+            }
+        }
+
+        parseDecimal(n.data(), n.size());
+        this->limbs.setNegative(isNegative && !this->limbs.empty());
+    }
+
+    BigInteger() : limbs{} {}
+
+    BigInteger(long long int n) : limbs{} {
+        unsigned long long int magnitude = n < 0 ?
+            0ULL - (unsigned long long int)n : (unsigned long long int)n;
+        if (magnitude != 0) {
+            this->limbs.push_back(magnitude);
+            this->limbs.setNegative(n < 0);
+        }
+    }
+
+    /*
+     * Builds a BigInteger from its decimal digits, least significant digit
+     * first.
+     */
+    BigInteger(std::vector<int> n) : limbs{} {
+        std::string digits(n.size(), '0');
+        for (size_t i = 0; i < n.size(); i++) {
+            digits[n.size() - i - 1] = (char)('0' + n[i]);
+        }
+        parseDecimal(digits.data(), digits.size());
+    }
+
+    /*
+     * Builds a non negative BigInteger from n limbs of its magnitude, least
+     * significant limb first.
+     */
+    BigInteger(const Limb* limbs, std::size_t n) : limbs{} {
+        this->limbs.assign(limbs, detail::normalizedSize(limbs, n));
+    }
+
+#ifdef BIGNUMERICS_HAS_MEMORY_RESOURCE
+    /*
+     * A zero whose limbs, and those of the results later assigned to it,
+     * come from the memory resource of allocator, a std::pmr arena for
+     * instance. Copies use the default resource like the std::pmr
+     * containers, see std::pmr::set_default_resource.
+     */
+    explicit BigInteger(
+        const std::pmr::polymorphic_allocator<Limb>& allocator) :
+        limbs{allocator.resource()} {}
+
+    BigInteger(const BigInteger& other,
+               const std::pmr::polymorphic_allocator<Limb>& allocator) :
+        limbs{other.limbs, allocator.resource()} {}
+
+    std::pmr::memory_resource* memoryResource() const {
+        return this->limbs.memoryResource();
+    }
+#endif
+
+    BigInteger(const BigInteger& other) = default;
+
+    BigInteger(BigInteger&& other) = default;
+
+    BigInteger& operator=(const BigInteger& other) = default;
+
+    BigInteger& operator=(BigInteger&& other) = default;
+
+    ~BigInteger() = default;
+
+    BigInteger& operator+=(const BigInteger& rhs) {
+        addSigned(rhs.limbs.data(), rhs.limbs.size(), rhs.limbs.negative());
+        return *this;
+    }
+
+    friend BigInteger operator+(BigInteger lhs, const BigInteger& rhs) {
+        lhs += rhs;
+        return lhs;
+    }
+
+    BigInteger& operator-=(const BigInteger& rhs) {
+        if (this == &rhs) {
+            this->limbs.clear();
+            this->limbs.setNegative(false);
+            return *this;
+        }
+
+        addSigned(rhs.limbs.data(), rhs.limbs.size(), !rhs.limbs.negative());
+        return *this;
+    }
+
+    friend BigInteger operator-(BigInteger lhs, const BigInteger& rhs) {
+        lhs -= rhs;
+        return lhs;
+    }
+
+    friend BigInteger operator-(BigInteger a) {
+        a.limbs.setNegative(!a.limbs.negative() && !a.limbs.empty());
+        return a;
+    }
+
+    BigInteger& operator*=(const BigInteger& rhs) {
+        multiplyBy(rhs.limbs.data(), rhs.limbs.size(), rhs.limbs.negative());
+        return *this;
+    }
+
+    /*
+     * this^2 through the squaring kernels, which compute only half of the
+     * partial products in the schoolbook loop and save an evaluation or a
+     * transform per step above it, about a third of a general product.
+     */
+    BigInteger square() const {
+        size_t n = this->limbs.size();
+        if (n == 0) {
+            return BigInteger();
+        }
+
+        detail::LimbVector result(2 * n);
+        detail::sqr(result.data(), this->limbs.data(), n);
+        removeLeadingZeroLimbs(result);
+        return BigInteger(std::move(result));
+    }
+
+    /*
+     * Products are evaluated lazily so that sums of products fuse into
+     * addmul and submul, see Expression.h. A product converts to a
+     * BigInteger wherever one is expected and refers to its operands,
+     * which must outlive it.
+     */
+    friend expression::Product<BigInteger> operator*(const BigInteger& lhs,
+                                                     const BigInteger& rhs) {
+        return expression::Product<BigInteger>(lhs, rhs);
+    }
+
+    // A product with a temporary operand is evaluated at once, into it.
+    friend BigInteger operator*(BigInteger&& lhs, const BigInteger& rhs) {
+        lhs *= rhs;
+        return std::move(lhs);
+    }
+
+    friend BigInteger operator*(const BigInteger& lhs, BigInteger&& rhs) {
+        rhs *= lhs;
+        return std::move(rhs);
+    }
+
+    friend BigInteger operator*(BigInteger&& lhs, BigInteger&& rhs) {
+        lhs *= rhs;
+        return std::move(lhs);
+    }
+
+    // this += a b, a and b may alias this.
+    BigInteger& addmul(const BigInteger& a, const BigInteger& b) {
+        addProduct(a, b, false);
+        return *this;
+    }
+
+    // this -= a b, a and b may alias this.
+    BigInteger& submul(const BigInteger& a, const BigInteger& b) {
+        addProduct(a, b, true);
+        return *this;
+    }
+
+    template <class E>
+    BigInteger& operator=(const expression::Expression<BigInteger, E>& e) {
+        if (expression::updateInPlace(*this, e)) {
+            return *this;
+        }
+
+        if (e.self().references(this)) {
+            *this = e.evaluate();
+            return *this;
+        }
+
+        // Reuses the limbs already allocated by this.
+        this->limbs.clear();
+        this->limbs.setNegative(false);
+        e.self().accumulate(*this, false);
+        return *this;
+    }
+
+    template <class E>
+    BigInteger& operator+=(const expression::Expression<BigInteger, E>& e) {
+        expression::accumulate(*this, e, false);
+        return *this;
+    }
+
+    template <class E>
+    BigInteger& operator-=(const expression::Expression<BigInteger, E>& e) {
+        expression::accumulate(*this, e, true);
+        return *this;
+    }
+
+    /*
+     * Computes quotient and remainder with a single division. The quotient
+     * is truncated toward zero and the remainder takes the sign of the
+     * dividend. q and r may alias a or b but not each other.
+     */
+    static void divmod(const BigInteger& a, const BigInteger& b,
+                       BigInteger& q, BigInteger& r) {
+        divideLimbs(a.limbs.data(), a.limbs.size(), a.limbs.negative(),
+                    b.limbs.data(), b.limbs.size(), b.limbs.negative(), q, r);
+    }
+
+    /*
+     * Truncating division, the quotient is rounded toward zero like the
+     * built-in integer types.
+     */
+    BigInteger& operator/=(const BigInteger& rhs) {
+        BigInteger remainder(
+            detail::LimbVector(this->limbs.memoryResource()));
+        divmod(*this, rhs, *this, remainder);
+        return *this;
+    }
+
+    friend BigInteger operator/(BigInteger lhs, const BigInteger& rhs) {
+        lhs /= rhs;
+        return lhs;
+    }
+
+    BigInteger& operator%=(const BigInteger& rhs) {
+        BigInteger quotient(
+            detail::LimbVector(this->limbs.memoryResource()));
+        divmod(*this, rhs, quotient, *this);
+        return *this;
+    }
+
+    friend BigInteger operator%(BigInteger lhs, const BigInteger& rhs) {
+        lhs %= rhs;
+        return lhs;
+    }
+
+#ifdef BIGNUMERICS_LITTLE_ENDIAN
+    /*
+     * The same operations with a BigIntegerView operand, whose limbs are
+     * read in place. The operators with a view on the left are declared by
+     * BigIntegerView.
+     */
+    BigInteger& operator+=(const BigIntegerView& rhs);
+    BigInteger& operator-=(const BigIntegerView& rhs);
+    BigInteger& operator*=(const BigIntegerView& rhs);
+    BigInteger& operator/=(const BigIntegerView& rhs);
+    BigInteger& operator%=(const BigIntegerView& rhs);
+
+    static void divmod(const BigIntegerView& a, const BigIntegerView& b,
+                       BigInteger& q, BigInteger& r);
+#endif
+
+    /*
+     * The integer square root floor(sqrt(this)), see sqrtrem(). Throws
+     * std::domain_error for negative numbers.
+     */
+    BigInteger isqrt() const {
+        BigInteger s;
+        BigInteger r;
+        sqrtrem(*this, s, r);
+        return s;
+    }
+
+    /*
+     * s = floor(sqrt(a)) and r = a - s^2. Newton's iteration doubles the
+     * number of correct leading bits of s per step and each step divides
+     * only the leading limbs of a it needs, so the root costs about two
+     * divisions of its length and the remainder one squaring. s and r may
+     * alias a but not each other.
+     */
+    static void sqrtrem(const BigInteger& a, BigInteger& s, BigInteger& r) {
+        if (a.limbs.negative()) {
+            throw std::domain_error(
+                "BigInteger: square root of a negative number");
+        }
+
+        BigInteger root = approximateSquareRoot(a);
+        BigInteger remainder = a;
+        remainder.submul(root, root);
+        if (remainder.limbs.negative()) {
+            // a - (root - 1)^2 = remainder + root + (root - 1)
+            remainder += root;
+            root -= one();
+            remainder += root;
+        }
+        s = std::move(root);
+        r = std::move(remainder);
+    }
+
+    /*
+     * The integer k-th root, truncated toward zero like the quotients:
+     * floor(this^(1 / k)) for positive numbers and, for odd k, minus the
+     * root of the magnitude for negative ones. Throws std::domain_error for
+     * even roots of negative numbers and std::invalid_argument for k = 0.
+     */
+    BigInteger iroot(unsigned long long k) const {
+        if (k == 0) {
+            throw std::invalid_argument("BigInteger: zeroth root");
+        }
+        if (this->limbs.negative() && k % 2 == 0) {
+            throw std::domain_error(
+                "BigInteger: even root of a negative number");
+        }
+        if (k == 1 || this->limbs.empty()) {
+            return *this;
+        }
+
+        BigInteger magnitude = *this;
+        magnitude.limbs.setNegative(false);
+        BigInteger root = k == 2 ? approximateSquareRoot(magnitude) :
+            approximateRoot(magnitude, k);
+        if (pow(root, k) > magnitude) {
+            root -= one();
+        }
+        root.limbs.setNegative(this->limbs.negative());
+        return root;
+    }
+
+    /*
+     * Multiplies by 10^k, or for negative k divides by 10^-k with the
+     * quotient truncated toward zero. As 10^k = 5^k 2^k only the power of
+     * five takes a multiplication or a division, a single limb pass for up
+     * to 27 digits, and the power of two is a shift.
+     */
+    BigInteger& scaleByPowerOfTen(long long k) {
+        if (k == 0 || this->limbs.empty()) {
+            return *this;
+        }
+
+        bool isNegative = this->limbs.negative();
+        unsigned long long digits = k < 0 ?
+            0ULL - (unsigned long long)k : (unsigned long long)k;
+        Limb power = 1;
+        for (unsigned long long i = 0; i < digits && i < 27; i++) {
+            power *= 5;
+        }
+
+        if (k > 0) {
+            if (digits <= 27) {
+                Limb carry = detail::mul1(this->limbs.data(),
+                                          this->limbs.data(),
+                                          this->limbs.size(), power);
+                if (carry != 0) {
+                    this->limbs.push_back(carry);
+                }
+            }
+            else {
+                *this *= pow(five(), digits);
+            }
+            *this = shiftedLeft(*this, digits);
+        }
+        else {
+            *this = shiftedRight(*this, digits);
+            if (digits <= 27) {
+                detail::divRem1(this->limbs.data(), this->limbs.data(),
+                                this->limbs.size(), power);
+                removeLeadingZeroLimbs(this->limbs);
+            }
+            else {
+                *this /= pow(five(), digits);
+            }
+        }
+
+        this->limbs.setNegative(isNegative && !this->limbs.empty());
+        return *this;
+    }
+
+    /*
+     * Multithreaded operations for huge operands, e.g.
+     * multiply(ParallelPolicy(pool), a, b). The Karatsuba, Toom-Cook and NTT
+     * sub-products, including those of the multiplications inside a
+     * division, are spread over the pool of the policy once they reach its
+     * grain. The results are the same as those of the serial operators.
+     */
+    friend BigInteger multiply(const ParallelPolicy& policy,
+                               const BigInteger& a, const BigInteger& b) {
+        detail::PoolScope scope(policy.threadPool());
+        return a * b;
+    }
+
+    friend BigInteger square(const ParallelPolicy& policy,
+                             const BigInteger& a) {
+        detail::PoolScope scope(policy.threadPool());
+        return a.square();
+    }
+
+    friend BigInteger divide(const ParallelPolicy& policy,
+                             const BigInteger& a, const BigInteger& b) {
+        detail::PoolScope scope(policy.threadPool());
+        return a / b;
+    }
+
+    static void divmod(const ParallelPolicy& policy,
+                       const BigInteger& a, const BigInteger& b,
+                       BigInteger& q, BigInteger& r) {
+        detail::PoolScope scope(policy.threadPool());
+        divmod(a, b, q, r);
+    }
+
+    friend BigInteger sum(const BigInteger* values, std::size_t count);
+    friend BigInteger sum(const ParallelPolicy& policy,
+                          const BigInteger* values, std::size_t count);
+    friend BigInteger product(const BigInteger* values, std::size_t count);
+    friend BigInteger product(const ParallelPolicy& policy,
+                              const BigInteger* values, std::size_t count);
+
+    friend BigInteger gcd(const BigInteger& a, const BigInteger& b);
+#ifdef BIGNUMERICS_LITTLE_ENDIAN
+    friend BigInteger gcd(const BigIntegerView& a, const BigIntegerView& b);
+#endif
+    friend BigInteger xgcd(const BigInteger& a, const BigInteger& b,
+                           BigInteger& s, BigInteger& t);
+    friend BigInteger modinv(const BigInteger& a, const BigInteger& m);
+
+    friend BigInteger pow(const BigInteger& base, unsigned long long exponent);
+
+    friend class MontgomeryContext;
+    friend class BarrettReducer;
+    friend class BigDecimal;
+    friend class BigIntegerView;
+    template <std::size_t Bits>
+    friend class FixedBigInt;
+    friend BigInteger powmod(const BigInteger& base,
+                             const BigInteger& exponent,
+                             const BigInteger& modulus);
+
+    friend inline bool operator==(const BigInteger& l, const BigInteger& r) {
+        return l.limbs.negative() == r.limbs.negative() && l.limbs == r.limbs;
+    }
+
+    friend inline bool operator!=(const BigInteger& l, const BigInteger& r) {
+        return !operator==(l, r);
+    }
+
+    friend inline bool operator<(const BigInteger& l, const BigInteger& r) {
+        if (l.limbs.negative() != r.limbs.negative()) {
+            return l.limbs.negative();
+        }
+
+        int c = compareMagnitudes(l, r);
+
+        return l.limbs.negative() ? c > 0 : c < 0;
+    }
+
+    friend inline bool operator>(const BigInteger& l, const BigInteger& r) {
+        return operator<(r, l);
+    }
+
+    friend inline bool operator<=(const BigInteger& l, const BigInteger& r) {
+        return !operator>(l, r);
+    }
+
+    friend inline bool operator>=(const BigInteger& l, const BigInteger& r) {
+        return !operator<(l, r);
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const BigInteger& bI) {
+        return os << bI.toString();
+    }
+
+    std::string toString() const {
+        std::string s = detail::toDecimal(this->limbs.data(),
+                                          this->limbs.size());
+        return this->limbs.negative() ? "-" + s : s;
+    }
+
+    // Bytes taken by the record of serialize().
+    std::size_t serializedSize() const {
+        return detail::SERIAL_HEADER_SIZE + this->limbs.size() * sizeof(Limb);
+    }
+
+    /*
+     * Appends the versioned, endian independent binary record of this to
+     * out, see detail::SERIAL_VERSION for its layout. Writing and reading
+     * it copy the limbs, where the decimal text costs a conversion.
+     */
+    void serialize(std::vector<unsigned char>& out) const {
+        detail::serializeRecord(out, this->limbs.data(), this->limbs.size(),
+                                this->limbs.negative(), false, 0);
+    }
+
+    /*
+     * Reads the record at the start of the size bytes of data, the record
+     * takes serializedSize() bytes of the result. Throws
+     * std::invalid_argument when it is truncated, malformed or holds a
+     * BigDecimal.
+     */
+    static BigInteger deserialize(const unsigned char* data,
+                                  std::size_t size) {
+        detail::SerialRecord record = detail::readSerialRecord(data, size,
+                                                               "BigInteger");
+        if (record.decimal) {
+            throw std::invalid_argument(
+                "BigInteger: the record holds a BigDecimal");
+        }
+
+        BigInteger n;
+        n.limbs.resize(record.n);
+        detail::loadLimbs(n.limbs.data(), record.limbs, record.n);
+        n.limbs.setNegative(record.negative);
+        return n;
+    }
+
+    // Shared constants, built once on first use.
+    static const BigInteger& zero() {
+        static const BigInteger value;
+        return value;
+    }
+
+    static const BigInteger& one() {
+        static const BigInteger value(1);
+        return value;
+    }
+
+    static const BigInteger& ten() {
+        static const BigInteger value(10);
+        return value;
+    }
+
+private:
+    // The magnitude, with the sign packed into its size word.
+    detail::LimbVector limbs;
+
+    // The base of the powers of five that scale by powers of ten.
+    static const BigInteger& five() {
+        static const BigInteger value(5);
+        return value;
+    }
+
+    explicit BigInteger(detail::LimbVector&& limbs) :
+        limbs{std::move(limbs)} {}
+
+    void parseDecimal(const char* digits, size_t size) {
+        std::vector<Limb> magnitude;
+        detail::parseDecimal(magnitude, digits, size);
+        this->limbs.assign(magnitude.data(), magnitude.size());
+    }
+
+    // |this| += b, the sign is left untouched.
+    void addMagnitude(const Limb* b, size_t bn) {
+        if (this->limbs.size() < bn) {
+            this->limbs.resize(bn);
+        }
+
+        Limb carry = detail::add(this->limbs.data(), this->limbs.data(),
+                                 this->limbs.size(), b, bn);
+        if (carry != 0) {
+            this->limbs.push_back(carry);
+        }
+    }
+
+    /*
+     * this += b for the magnitude b and the sign bNegative. b may be the
+     * limbs of this, they are only reallocated once the carry is known.
+     */
+    void addSigned(const Limb* b, size_t bn, bool bNegative) {
+        if (this->limbs.negative() == bNegative) {
+            addMagnitude(b, bn);
+        }
+        else {
+            subtractMagnitude(b, bn);
+        }
+    }
+
+    // this *= b for the magnitude b and the sign bNegative.
+    void multiplyBy(const Limb* b, size_t n, bool bNegative) {
+        size_t m = this->limbs.size();
+        if (m == 0 || n == 0) {
+            *this = BigInteger();
+            return;
+        }
+
+        detail::LimbVector result(m + n, this->limbs.memoryResource());
+        multiplyMagnitudes(result.data(), this->limbs.data(), m, b, n);
+        removeLeadingZeroLimbs(result);
+        result.setNegative(this->limbs.negative() != bNegative);
+        this->limbs.swap(result);
+    }
+
+    // The m + n limbs r = a b, r aliases neither a nor b.
+    static void multiplyMagnitudes(Limb* r, const Limb* a, size_t m,
+                                   const Limb* b, size_t n) {
+        if (m >= n) {
+            detail::mul(r, a, m, b, n);
+        }
+        else {
+            detail::mul(r, b, n, a, m);
+        }
+    }
+
+    /*
+     * divmod() of the magnitude a of sign aNegative by the magnitude b of
+     * sign bNegative. q and r may hold a or b but not each other.
+     */
+    static void divideLimbs(const Limb* a, size_t m, bool aNegative,
+                            const Limb* b, size_t n, bool bNegative,
+                            BigInteger& q, BigInteger& r) {
+        if (n == 0) {
+            throw std::domain_error("BigInteger: division by zero");
+        }
+
+        bool quotientNegative = aNegative != bNegative;
+        bool remainderNegative = aNegative;
+
+        if (m < n || (m == n && detail::cmp(a, b, n) < 0)) {
+            if (r.limbs.data() != a) {
+                r.limbs.assign(a, m);
+            }
+            r.limbs.setNegative(remainderNegative && m != 0);
+            q.limbs.clear();
+            q.limbs.setNegative(false);
+            return;
+        }
+
+        detail::LimbVector quotient(m - n + 1, q.limbs.memoryResource());
+        detail::LimbVector remainder(n, r.limbs.memoryResource());
+
+        detail::divRem(quotient.data(), remainder.data(), a, m, b, n,
+                       q.limbs.memoryResource());
+
+        removeLeadingZeroLimbs(quotient);
+        removeLeadingZeroLimbs(remainder);
+        q.limbs.swap(quotient);
+        q.limbs.setNegative(quotientNegative && !q.limbs.empty());
+        r.limbs.swap(remainder);
+        r.limbs.setNegative(remainderNegative && !r.limbs.empty());
+    }
+
+    // |this| -= b, the sign flips when b is the larger magnitude.
+    void subtractMagnitude(const Limb* b, size_t bn) {
+        size_t an = this->limbs.size();
+
+        int c = an != bn ? (an < bn ? -1 : 1) :
+            detail::cmp(this->limbs.data(), b, an);
+
+        if (c == 0) {
+            this->limbs.clear();
+            this->limbs.setNegative(false);
+            return;
+        }
+
+        if (c > 0) {
+            detail::sub(this->limbs.data(), this->limbs.data(), an, b, bn);
+        }
+        else {
+            this->limbs.resize(bn);
+            detail::sub(this->limbs.data(), b, bn, this->limbs.data(), an);
+            this->limbs.setNegative(!this->limbs.negative());
+        }
+
+        removeLeadingZeroLimbs(this->limbs);
+    }
+
+    void addProduct(const BigInteger& a, const BigInteger& b, bool subtract) {
+        const BigInteger* u = &a;
+        const BigInteger* v = &b;
+        if (u->limbs.size() < v->limbs.size()) {
+            std::swap(u, v);
+        }
+
+        size_t m = u->limbs.size();
+        size_t n = v->limbs.size();
+        if (n == 0) {
+            return;
+        }
+
+        bool productNegative =
+            (a.limbs.negative() != b.limbs.negative()) != subtract;
+        bool empty = this->limbs.empty();
+        if (empty) {
+            this->limbs.setNegative(productNegative);
+        }
+
+        // Short products of the same sign accumulate row by row straight
+        // into the destination, except squares that make up the whole
+        // result, as in BigInteger y = x * x, which go to sqr().
+        if (productNegative == this->limbs.negative() &&
+            n < detail::KARATSUBA_THRESHOLD && this != u && this != v &&
+            !(empty && u == v)) {
+            size_t rn = std::max(this->limbs.size(), m + n) + 1;
+            this->limbs.resize(rn);
+
+            Limb* r = this->limbs.data();
+            for (size_t j = 0; j < n; j++) {
+                Limb carry = detail::addMul1(r + j, u->limbs.data(), m,
+                                             v->limbs[j]);
+                detail::add1(r + j + m, r + j + m, rn - j - m, carry);
+            }
+
+            removeLeadingZeroLimbs(this->limbs);
+            return;
+        }
+
+        detail::LimbVector product(m + n, this->limbs.memoryResource());
+        detail::mul(product.data(), u->limbs.data(), m, v->limbs.data(), n);
+        if (empty) {
+            removeLeadingZeroLimbs(product);
+            product.setNegative(productNegative);
+            this->limbs.swap(product);
+            return;
+        }
+
+        size_t pn = detail::normalizedSize(product.data(), m + n);
+        if (productNegative == this->limbs.negative()) {
+            addMagnitude(product.data(), pn);
+        }
+        else {
+            subtractMagnitude(product.data(), pn);
+        }
+    }
+
+    static int compareMagnitudes(const BigInteger& l, const BigInteger& r) {
+        if (l.limbs.size() != r.limbs.size()) {
+            return l.limbs.size() < r.limbs.size() ? -1 : 1;
+        }
+        return detail::cmp(l.limbs.data(), r.limbs.data(), l.limbs.size());
+    }
+
+    static void removeLeadingZeroLimbs(detail::LimbVector& v) {
+        v.resize(detail::normalizedSize(v.data(), v.size()));
+    }
+
+    // offsets[i] = the number of limbs in values[0, i).
+    static std::vector<std::size_t> limbOffsets(const BigInteger* values,
+                                                std::size_t count) {
+        std::vector<std::size_t> offsets(count + 1, 0);
+        for (std::size_t i = 0; i < count; i++) {
+            offsets[i + 1] = offsets[i] + values[i].limbs.size();
+        }
+        return offsets;
+    }
+
+    /*
+     * Adds the positive values of [first, last) to sums[0] and the
+     * magnitudes of the negative ones to sums[1]. With offsets the range is
+     * halved into a tree reduction over the current pool, additions cost
+     * little per limb so only ranges of 64 grains fork.
+     */
+    static void sumTree(const BigInteger* values, const std::size_t* offsets,
+                        std::size_t first, std::size_t last,
+                        detail::CarrySaveSum* sums) {
+        if (offsets == nullptr || last - first < 2 ||
+            !detail::forkable((offsets[last] - offsets[first]) / 64)) {
+            for (std::size_t i = first; i < last; i++) {
+                if (i + 8 < last) {
+                    __builtin_prefetch(values[i + 8].limbs.data());
+                }
+                const detail::LimbVector& v = values[i].limbs;
+                sums[v.negative() ? 1 : 0].add(v.data(), v.size());
+            }
+            return;
+        }
+
+        std::size_t middle = first + (last - first) / 2;
+        detail::CarrySaveSum right[2];
+        detail::TaskGroup tasks;
+        tasks.run([&] { sumTree(values, offsets, middle, last, right); });
+        sumTree(values, offsets, first, middle, sums);
+        tasks.wait();
+
+        sums[0].add(right[0]);
+        sums[1].add(right[1]);
+    }
+
+    static BigInteger sumOf(const BigInteger* values,
+                            const std::size_t* offsets, std::size_t count) {
+        detail::CarrySaveSum sums[2];
+        sumTree(values, offsets, 0, count, sums);
+
+        BigInteger result;
+        BigInteger negative;
+        sums[0].normalize(result.limbs);
+        sums[1].normalize(negative.limbs);
+        result -= negative;
+        return result;
+    }
+
+    /*
+     * The product of values[first, last) as a balanced tree: the range is
+     * split where half of its limbs lie on either side so that the
+     * multiplications near the root have operands of similar length.
+     * Ranges small enough for the schoolbook loop are multiplied in order.
+     */
+    static BigInteger productTree(const BigInteger* values,
+                                  const std::size_t* offsets,
+                                  std::size_t first, std::size_t last) {
+        std::size_t limbs = offsets[last] - offsets[first];
+        if (last - first == 1 || limbs < 2 * detail::KARATSUBA_THRESHOLD) {
+            BigInteger result = values[first];
+            for (std::size_t i = first + 1; i < last; i++) {
+                result *= values[i];
+            }
+            return result;
+        }
+
+        std::size_t middle = std::upper_bound(offsets + first + 1,
+                                              offsets + last,
+                                              offsets[first] + limbs / 2) -
+                             offsets;
+        middle = std::max(first + 1, std::min(middle, last - 1));
+
+        BigInteger left;
+        BigInteger right;
+        if (detail::forkable(limbs)) {
+            detail::TaskGroup tasks;
+            tasks.run([&] {
+                right = productTree(values, offsets, middle, last);
+            });
+            left = productTree(values, offsets, first, middle);
+            tasks.wait();
+        }
+        else {
+            left = productTree(values, offsets, first, middle);
+            right = productTree(values, offsets, middle, last);
+        }
+        return left * right;
+    }
+
+    static BigInteger productOf(const BigInteger* values, std::size_t count) {
+        if (count == 0) {
+            return one();
+        }
+
+        for (std::size_t i = 0; i < count; i++) {
+            if (values[i].limbs.empty()) {
+                return BigInteger();
+            }
+        }
+
+        std::vector<std::size_t> offsets = limbOffsets(values, count);
+        return productTree(values, offsets.data(), 0, count);
+    }
+
+    static BigInteger fromSignedLimbs(const detail::SignedLimbs& x) {
+        BigInteger r;
+        r.limbs.assign(x.limbs.data(), x.limbs.size());
+        r.limbs.setNegative(x.negative && !x.limbs.empty());
+        return r;
+    }
+
+    /*
+     * g = gcd(a, b) and s with s a = g mod b, |s| <= |b| / 2g. Only the
+     * cofactor of a is followed through the reduction, the one of b costs
+     * a division afterwards.
+     */
+    static BigInteger extendedGcd(const BigInteger& a, const BigInteger& b,
+                                  BigInteger& s) {
+        detail::SignedLimbs x(a.limbs.data(), a.limbs.size());
+        detail::SignedLimbs y(b.limbs.data(), b.limbs.size());
+        if (y.limbs.empty()) {
+            s = BigInteger(a.limbs.empty() ? 0 : a.limbs.negative() ? -1 : 1);
+            return fromSignedLimbs(x);
+        }
+
+        detail::SignedLimbs u[2];
+        u[0].limbs.push_back(1);
+        detail::gcdReduce(x, y, u);
+        BigInteger g = fromSignedLimbs(x);
+
+        // The cofactors of g are unique modulo |b| / g, the one closest to
+        // zero is kept.
+        BigInteger period = fromSignedLimbs(
+            detail::SignedLimbs(b.limbs.data(), b.limbs.size())) / g;
+        BigInteger cofactor = fromSignedLimbs(u[0]) % period;
+        BigInteger twice = cofactor + cofactor;
+        if (twice > period) {
+            cofactor -= period;
+        }
+        else if (twice + period <= BigInteger()) {
+            cofactor += period;
+        }
+
+        if (a.limbs.negative() && !cofactor.limbs.empty()) {
+            cofactor.limbs.setNegative(!cofactor.limbs.negative());
+        }
+        s = std::move(cofactor);
+        return g;
+    }
+
+    static std::size_t bitLength(const BigInteger& a) {
+        std::size_t size = a.limbs.size();
+        return size == 0 ? 0 : size * detail::LIMB_BITS -
+            detail::countLeadingZeroes(a.limbs[size - 1]);
+    }
+
+    // |a| 2^bits.
+    static BigInteger shiftedLeft(const BigInteger& a, std::size_t bits) {
+        std::size_t n = a.limbs.size();
+        if (n == 0) {
+            return BigInteger();
+        }
+
+        std::size_t offset = bits / detail::LIMB_BITS;
+        unsigned s = bits % detail::LIMB_BITS;
+        detail::LimbVector r(offset + n + 1);
+        if (s == 0) {
+            std::copy(a.limbs.data(), a.limbs.data() + n, r.data() + offset);
+        }
+        else {
+            r[offset + n] = detail::lshift(r.data() + offset, a.limbs.data(),
+                                           n, s);
+        }
+        removeLeadingZeroLimbs(r);
+        return BigInteger(std::move(r));
+    }
+
+    // floor(|a| / 2^bits).
+    static BigInteger shiftedRight(const BigInteger& a, std::size_t bits) {
+        std::size_t offset = bits / detail::LIMB_BITS;
+        if (offset >= a.limbs.size()) {
+            return BigInteger();
+        }
+
+        std::size_t n = a.limbs.size() - offset;
+        unsigned s = bits % detail::LIMB_BITS;
+        detail::LimbVector r(n);
+        if (s == 0) {
+            std::copy(a.limbs.data() + offset, a.limbs.data() + offset + n,
+                      r.data());
+        }
+        else {
+            detail::rshift(r.data(), a.limbs.data() + offset, n, s);
+        }
+        removeLeadingZeroLimbs(r);
+        return BigInteger(std::move(r));
+    }
+
+    /*
+     * floor(sqrt(a)) or one more, for a >= 0. With c = floor((bits - 1) / 2)
+     * every pass extends the d leading bits of the root known to the next
+     * prefix of c, the Newton step x + a / x, with a cut to the matching
+     * bits, yields them to within a unit. The passes up to 32 bits run on
+     * single limbs.
+     */
+    static BigInteger approximateSquareRoot(const BigInteger& a) {
+        if (a.limbs.size() <= 1) {
+            Limb root = detail::sqrt1(a.limbs.empty() ? 0 : a.limbs[0]);
+            return BigInteger((long long)root);
+        }
+
+        std::size_t c = (bitLength(a) - 1) / 2;
+        int pass = 63 - __builtin_clzll(c);
+        std::size_t d = 0;
+
+        Limb small = 1;
+        for (; pass >= 0 && (c >> pass) < 32; pass--) {
+            std::size_t e = d;
+            d = c >> pass;
+            Limb leading = shiftedRight(a, 2 * c - e - d + 1).limbs[0];
+            small = (small << (d - e - 1)) + leading / small;
+        }
+
+        BigInteger x((long long)small);
+        for (; pass >= 0; pass--) {
+            std::size_t e = d;
+            d = c >> pass;
+            BigInteger q = shiftedRight(a, 2 * c - e - d + 1) / x;
+            x = shiftedLeft(x, d - e - 1);
+            x += q;
+        }
+        return x;
+    }
+
+    /*
+     * floor(a^(1/k)) or one more, for a > 0 and k >= 2. The root r of the
+     * leading bits a / 2^(k s) is known to half the precision, so
+     * (r + 1) 2^s exceeds the root by at most 2^(s + 1) and a single Newton
+     * step from it leaves an error of (k - 1) 2^(2s + 1) / a^(1/k), less than
+     * a unit for the s below. Roots of up to 32 bits are taken from a double
+     * and corrected.
+     */
+    static BigInteger approximateRoot(const BigInteger& a,
+                                      unsigned long long k) {
+        std::size_t bits = bitLength(a);
+        if (bits <= k) {
+            return one();
+        }
+
+        std::size_t rootBits = (bits - 1) / k;
+        std::size_t kBits = 64 - __builtin_clzll(k);
+        if (rootBits < 32) {
+            return smallRoot(a, k);
+        }
+
+        std::size_t s = rootBits > kBits + 3 ? (rootBits - kBits - 2) / 2 : 1;
+        BigInteger x = approximateRoot(shiftedRight(a, k * s), k);
+        x += one();
+
+        // ((k - 1) x 2^s + a / (x 2^s)^(k - 1)) / k
+        BigInteger q = shiftedRight(a, s * (k - 1)) / pow(x, k - 1);
+        x *= BigInteger((long long)(k - 1));
+        BigInteger y = shiftedLeft(x, s);
+        y += q;
+        y /= BigInteger((long long)k);
+        return y;
+    }
+
+    // floor(a^(1/k)) for a root below 2^32.
+    static BigInteger smallRoot(const BigInteger& a, unsigned long long k) {
+        std::size_t bits = bitLength(a);
+        std::size_t shift = bits > detail::LIMB_BITS ?
+            bits - detail::LIMB_BITS : 0;
+        double leading = (double)shiftedRight(a, shift).limbs[0];
+        double estimate = std::exp2((std::log2(leading) + shift) / k);
+
+        BigInteger root((long long)estimate);
+        while (pow(root + one(), k) <= a) {
+            root += one();
+        }
+        while (pow(root, k) > a) {
+            root -= one();
+        }
+        return root;
+    }
+};
+
+// Also makes the parallel operations reachable as BigNumerics::multiply etc.
+BigInteger multiply(const ParallelPolicy& policy,
+                    const BigInteger& a, const BigInteger& b);
+BigInteger square(const ParallelPolicy& policy, const BigInteger& a);
+BigInteger divide(const ParallelPolicy& policy,
+                  const BigInteger& a, const BigInteger& b);
 
-class BigInteger {
+/*
+ * Sum of count values. The magnitudes are added without propagating carries
+ * and the carries are folded in once at the end, positive and negative
+ * values are summed apart and subtracted last.
+ */
+inline BigInteger sum(const BigInteger* values, std::size_t count) {
+    return BigInteger::sumOf(values, nullptr, count);
+}
 
-public:
-    BigInteger(std::string n) {
-        if (n.size() > 0 && n[0] == '-') {
-            this->negative = true;
-            n.erase(0, 1);
-        }
-        else {
-            this->negative = false;
-        }
+inline BigInteger sum(const ParallelPolicy& policy,
+                      const BigInteger* values, std::size_t count) {
+    detail::PoolScope scope(policy.threadPool());
+    std::vector<std::size_t> offsets = BigInteger::limbOffsets(values, count);
+    return BigInteger::sumOf(values, offsets.data(), count);
+}
 
-        this->integral = std::vector<int>(n.size());
+/*
+ * Product of count values by a balanced product tree, which keeps the large
+ * multiplications subquadratic. The product of no values is one.
+ */
+inline BigInteger product(const BigInteger* values, std::size_t count) {
+    return BigInteger::productOf(values, count);
+}
 
-        int sizeInt = this->integral.size();
-        for (int i = 0; i < sizeInt; i++) {
-            this->integral[i] = n[sizeInt - i - 1] - '0';
-        }
+inline BigInteger product(const ParallelPolicy& policy,
+                          const BigInteger* values, std::size_t count) {
+    detail::PoolScope scope(policy.threadPool());
+    return BigInteger::productOf(values, count);
+}
 
-        removeIntegralLeadingZeroes(this->integral);
-    }
+template <class Allocator>
+BigInteger sum(const std::vector<BigInteger, Allocator>& values) {
+    return sum(values.data(), values.size());
+}
 
-    BigInteger() : integral{}, negative{false} {}
+template <class Allocator>
+BigInteger sum(const ParallelPolicy& policy,
+               const std::vector<BigInteger, Allocator>& values) {
+    return sum(policy, values.data(), values.size());
+}
 
-    BigInteger(std::vector<int> n) : integral{n}, negative{false} {
-        removeIntegralLeadingZeroes(this->integral);
-    }
+template <class Allocator>
+BigInteger product(const std::vector<BigInteger, Allocator>& values) {
+    return product(values.data(), values.size());
+}
 
-    ~BigInteger() = default;
+template <class Allocator>
+BigInteger product(const ParallelPolicy& policy,
+                   const std::vector<BigInteger, Allocator>& values) {
+    return product(policy, values.data(), values.size());
+}
 
-    BigInteger& operator+=(const BigInteger& rhs) {
+#ifdef BIGNUMERICS_HAS_SPAN
+inline BigInteger sum(std::span<const BigInteger> values) {
+    return sum(values.data(), values.size());
+}
 
-        if ((this->negative && rhs.negative) ||
-            (this->negative && !rhs.negative) ||
-            (!this->negative && rhs.negative)) {
-            BigInteger rightHandSide = rhs;
+inline BigInteger sum(const ParallelPolicy& policy,
+                      std::span<const BigInteger> values) {
+    return sum(policy, values.data(), values.size());
+}
 
-            if (this->negative && !rhs.negative) {
-                std::swap(*this, rightHandSide);
-            }
+inline BigInteger product(std::span<const BigInteger> values) {
+    return product(values.data(), values.size());
+}
 
-            rightHandSide.negative = false;
-            *this -= rightHandSide;
-            return *this;
-        }
+inline BigInteger product(const ParallelPolicy& policy,
+                          std::span<const BigInteger> values) {
+    return product(policy, values.data(), values.size());
+}
+#endif
 
-        BigInteger result;
-        result.negative = false;
+// Greatest common divisor of |a| and |b|, gcd(0, 0) = 0.
+inline BigInteger gcd(const BigInteger& a, const BigInteger& b) {
+    detail::SignedLimbs x(a.limbs.data(), a.limbs.size());
+    detail::SignedLimbs y(b.limbs.data(), b.limbs.size());
+    detail::gcdReduce(x, y, nullptr);
+    return BigInteger::fromSignedLimbs(x);
+}
 
-        bool carry = false;
+/*
+ * Extended GCD: returns g = gcd(a, b) and sets s and t to cofactors with
+ * s a + t b = g, |s| <= |b| / 2g and |t| <= |a| / 2g + 1. s and t may
+ * alias a or b.
+ */
+inline BigInteger xgcd(const BigInteger& a, const BigInteger& b,
+                       BigInteger& s, BigInteger& t) {
+    BigInteger cofactor;
+    BigInteger g = BigInteger::extendedGcd(a, b, cofactor);
 
-        int integralSize = std::max(this->integral.size(), rhs.integral.size());
+    // t = (g - s a) / b, which is exact.
+    BigInteger other = g;
+    if (b.limbs.empty()) {
+        other = BigInteger();
+    }
+    else {
+        other.submul(cofactor, a);
+        other /= b;
+    }
+    s = std::move(cofactor);
+    t = std::move(other);
+    return g;
+}
 
-        result.integral = std::vector<int>(integralSize);
+/*
+ * The inverse of a modulo m > 0, in [0, m). Throws std::domain_error when
+ * a and m are not coprime.
+ */
+inline BigInteger modinv(const BigInteger& a, const BigInteger& m) {
+    if (m.limbs.negative() || m.limbs.empty()) {
+        throw std::domain_error("BigInteger: the modulus must be positive");
+    }
 
-        int minIntegralSize = std::min(this->integral.size(), rhs.integral.size());
+    BigInteger s;
+    BigInteger g = BigInteger::extendedGcd(a % m, m, s);
+    if (g != BigInteger::one()) {
+        throw std::domain_error("BigInteger: no inverse modulo the modulus");
+    }
+    if (s.limbs.negative()) {
+        s += m;
+    }
+    return s;
+}
 
-        for (int i = 0; i < minIntegralSize; i++) {
-            int r = this->integral[i] + rhs.integral[i] + carry;
-            if (r >= 10) {
-                carry = true;
-            }
-            else {
-                carry = false;
-            }
-            result.integral[i] = (r % 10);
+/*
+ * base^exponent, with 0^0 = 1. The exponent bits are scanned from the top
+ * in sliding windows: every bit costs a squaring and every window a single
+ * multiplication by one of the precomputed odd powers of the base.
+ */
+inline BigInteger pow(const BigInteger& base, unsigned long long exponent) {
+    if (exponent == 0) {
+        return BigInteger::one();
+    }
+
+    std::size_t bits = 64 - __builtin_clzll(exponent);
+    std::size_t window = bits <= 8 ? 1 : bits <= 24 ? 2 : 3;
+
+    // powers holds base^1, base^3, ... base^(2^window - 1).
+    std::vector<BigInteger> powers((std::size_t)1 << (window - 1));
+    powers[0] = base;
+    if (window > 1) {
+        BigInteger square = base.square();
+        for (std::size_t i = 1; i < powers.size(); i++) {
+            powers[i] = powers[i - 1];
+            powers[i] *= square;
         }
+    }
 
-        if (this->integral.size() != rhs.integral.size()) {
-            for (int i = minIntegralSize; i < integralSize; i++) {
-                int r = 0;
-                if (this->integral.size() == integralSize) {
-                    r = this->integral[i] + carry;
-                }
-                else {
-                    r = rhs.integral[i] + carry;
-                }
+    auto bit = [exponent](std::size_t i) {
+        return (exponent >> i) & 1;
+    };
 
-                if (r >= 10) {
-                    carry = true;
-                }
-                else {
-                    carry = false;
-                }
-                result.integral[i] = (r % 10);
+    BigInteger x;
+    bool first = true;
+    for (std::size_t i = bits; i > 0;) {
+        if (bit(i - 1) == 0) {
+            x = x.square();
+            i--;
+            continue;
+        }
+
+        // The longest window of at most window bits ending on a one.
+        std::size_t low = i > window ? i - window : 0;
+        while (bit(low) == 0) {
+            low++;
+        }
+        std::size_t value = 0;
+        for (std::size_t j = i; j > low; j--) {
+            value = 2 * value + bit(j - 1);
+        }
+
+        if (first) {
+            x = powers[value / 2];
+            first = false;
+        }
+        else {
+            for (std::size_t j = low; j < i; j++) {
+                x = x.square();
             }
+            x *= powers[value / 2];
+        }
+        i = low;
+    }
+    return x;
+}
+
+/*
+ * Modular arithmetic by a fixed odd modulus m in Montgomery form, where a
+ * residue a is represented by a R mod m with R = 2^(64 n) for the n limbs of
+ * m. Products of representations are reduced by a division by R, which
+ * needs no trial quotients, so a modular exponentiation costs about two
+ * multiplications per exponent bit and no division at all.
+ *
+ * fromMontgomery(), multiply() and square() take representations in
+ * [0, m) and throw std::invalid_argument for anything else, convert other
+ * values with toMontgomery(). A context is immutable once built and can be
+ * shared by several threads.
+ */
+class MontgomeryContext {
+
+public:
+    typedef detail::Limb Limb;
+
+    explicit MontgomeryContext(const BigInteger& modulus) :
+        m{modulus}, n{modulus.limbs.size()}, mInverse{0} {
+        if (this->m.limbs.negative() || this->m.limbs.empty() ||
+            this->m.limbs[0] % 2 == 0) {
+            throw std::invalid_argument(
+                "MontgomeryContext: the modulus must be positive and odd");
         }
 
-        if (carry) {
-            result.integral.push_back(1);
+        const Limb* mp = this->m.limbs.data();
+        this->mInverse = 0 - detail::inverseModLimb(mp[0]);
+        if (this->n >= detail::REDC_THRESHOLD) {
+            this->mNegInverse.resize(this->n);
+            detail::inverseModPower(this->mNegInverse.data(), mp, this->n);
+            for (std::size_t i = 0; i < this->n; i++) {
+                this->mNegInverse[i] = ~this->mNegInverse[i];
+            }
+            detail::add1(this->mNegInverse.data(), this->mNegInverse.data(),
+                         this->n, 1);
         }
 
-        *this = result;
+        // R^2 mod m converts into Montgomery form with one multiplication.
+        detail::LimbVector rSquared(2 * this->n + 1);
+        rSquared[2 * this->n] = 1;
+        this->r2 = BigInteger(std::move(rSquared)) % this->m;
+        this->r1 = fromMontgomery(this->r2);
+    }
 
-        removeIntegralLeadingZeroes(this->integral);
+    const BigInteger& modulus() const {
+        return this->m;
+    }
 
-        return *this;
+    // a R mod m for any a, negative values included.
+    BigInteger toMontgomery(const BigInteger& a) const {
+        return multiply(residue(a), this->r2);
     }
 
-    friend BigInteger operator+(BigInteger lhs, const BigInteger& rhs) {
-        lhs += rhs;
-        return lhs;
+    // a / R mod m, the residue represented by a.
+    BigInteger fromMontgomery(const BigInteger& a) const {
+        checkRepresentation(a);
+        std::vector<Limb> t(2 * this->n);
+        std::copy(a.limbs.data(), a.limbs.data() + a.limbs.size(), t.data());
+        return reduce(t);
     }
 
-    BigInteger& operator-=(const BigInteger& rhs) {
-        if (*this == rhs) {
-            *this = BigInteger("0");
-            return *this;
+    // a b / R mod m, the representation of the product.
+    BigInteger multiply(const BigInteger& a, const BigInteger& b) const {
+        checkRepresentation(a);
+        checkRepresentation(b);
+        std::vector<Limb> t(2 * this->n);
+        std::size_t an = a.limbs.size();
+        std::size_t bn = b.limbs.size();
+        if (an != 0 && bn != 0) {
+            if (an >= bn) {
+                detail::mul(t.data(), a.limbs.data(), an, b.limbs.data(), bn);
+            }
+            else {
+                detail::mul(t.data(), b.limbs.data(), bn, a.limbs.data(), an);
+            }
         }
+        return reduce(t);
+    }
 
-        BigInteger result;
-        BigInteger rightHandSide = rhs;
+    BigInteger square(const BigInteger& a) const {
+        return multiply(a, a);
+    }
 
-        if (this->negative && !rightHandSide.negative) {
-            this->negative = false;
-            *this += rightHandSide;
-            this->negative = true;
-            return *this;
+    /*
+     * base^exponent mod m, from and to the usual representation. A negative
+     * exponent raises the inverse of base, see modinv(). Left-to-right
+     * sliding windows over the exponent bits multiply by precomputed odd
+     * powers of the base, so that a k bit window saves all but one of its
+     * k multiplications.
+     */
+    BigInteger powmod(const BigInteger& base,
+                      const BigInteger& exponent) const {
+        if (exponent.limbs.negative()) {
+            return powmod(modinv(base, this->m), -exponent);
         }
-        else if (!this->negative && rightHandSide.negative) {
-            rightHandSide.negative = false;
-            *this += rightHandSide;
-            this->negative = false;
-            return *this;
+
+        std::size_t bits = BigInteger::bitLength(exponent);
+        if (bits == 0) {
+            return BigInteger::one() % this->m;
         }
+        return powmodBits(toMontgomery(base), exponent.limbs.data(), bits);
+    }
 
-        if (!this->negative && !rightHandSide.negative) {
-            if (*this < rightHandSide) {
-                std::swap(*this, rightHandSide);
-                result.negative = true;
-            }
-            else {
-                result.negative = false;
+#ifdef BIGNUMERICS_LITTLE_ENDIAN
+    // The same with the limbs of base and exponent read in place.
+    BigInteger powmod(const BigIntegerView& base,
+                      const BigIntegerView& exponent) const;
+#endif
+
+    // The representation of one, R mod m.
+    const BigInteger& one() const {
+        return this->r1;
+    }
+
+private:
+    BigInteger m;
+    std::size_t n;
+    Limb mInverse;
+    std::vector<Limb> mNegInverse;
+    BigInteger r2;
+    BigInteger r1;
+
+    /*
+     * The residue of a^e from the representation a and the bits long
+     * exponent e, bits > 0.
+     */
+    BigInteger powmodBits(const BigInteger& a, const Limb* e,
+                          std::size_t bits) const {
+        std::size_t window = detail::powmodWindow(bits);
+        std::size_t n = this->n;
+        std::vector<Limb> powers(n << (window - 1));
+        std::vector<Limb> x(n);
+        std::vector<Limb> scratch(scratchSize());
+        store(powers.data(), a);
+
+        // powers holds base^1, base^3, ... base^(2^window - 1).
+        if (window > 1) {
+            multiplyLimbs(x.data(), powers.data(), powers.data(),
+                          scratch.data());
+            for (std::size_t i = 1; i < (std::size_t)1 << (window - 1); i++) {
+                multiplyLimbs(powers.data() + i * n,
+                              powers.data() + (i - 1) * n, x.data(),
+                              scratch.data());
             }
         }
 
-        if (this->negative && rightHandSide.negative) {
-            if (*this > rightHandSide) {
-                std::swap(*this, rightHandSide);
-                result.negative = false;
+        auto bit = [e](std::size_t i) {
+            return (e[i / detail::LIMB_BITS] >> (i % detail::LIMB_BITS)) & 1;
+        };
+
+        bool first = true;
+        for (std::size_t i = bits; i > 0;) {
+            if (bit(i - 1) == 0) {
+                multiplyLimbs(x.data(), x.data(), x.data(), scratch.data());
+                i--;
+                continue;
             }
-            else {
-                result.negative = true;
+
+            // The longest window of at most window bits ending on a one.
+            std::size_t low = i > window ? i - window : 0;
+            while (bit(low) == 0) {
+                low++;
+            }
+            std::size_t value = 0;
+            for (std::size_t j = i; j > low; j--) {
+                value = 2 * value + bit(j - 1);
             }
-        }
 
-        if (this->integral.size() != rightHandSide.integral.size()) {
-            int delta = 0;
-            if (this->integral.size() > rightHandSide.integral.size()) {
-                delta = this->integral.size() -
-                    rightHandSide.integral.size();
-                appendZeroes(rightHandSide.integral, delta);
+            const Limb* power = powers.data() + (value / 2) * n;
+            if (first) {
+                std::copy(power, power + n, x.data());
+                first = false;
             }
             else {
-                delta = rightHandSide.integral.size() -
-                    this->integral.size();
-                appendZeroes(this->integral, delta);
+                for (std::size_t j = low; j < i; j++) {
+                    multiplyLimbs(x.data(), x.data(), x.data(),
+                                  scratch.data());
+                }
+                multiplyLimbs(x.data(), x.data(), power, scratch.data());
             }
+            i = low;
         }
 
-        result.integral = std::vector<int>(this->integral.size());
+        x.resize(2 * n);
+        return reduce(x);
+    }
 
-        int j = 0;
-        int k = 0;
+    static detail::LimbVector limbsOf(const Limb* a, std::size_t n) {
+        detail::LimbVector limbs;
+        limbs.assign(a, detail::normalizedSize(a, n));
+        return limbs;
+    }
 
-        while (j < this->integral.size()) {
-            int r = this->integral[j] - rightHandSide.integral[j];
-            result.integral[j] = positiveModulo(r + k, 10);
-            k = std::floor((r + k) / 10.0);
-            j++;
+    // Keeps the n limb buffers of the public operations in bounds.
+    void checkRepresentation(const BigInteger& a) const {
+        if (a.limbs.negative() ||
+            BigInteger::compareMagnitudes(a, this->m) >= 0) {
+            throw std::invalid_argument(
+                "MontgomeryContext: a representation lies in [0, modulus)");
         }
+    }
 
-        *this = result;
-        removeIntegralLeadingZeroes(this->integral);
+    // a mod m in [0, m), a is a BigInteger or a BigIntegerView.
+    template <class Integer>
+    BigInteger residue(const Integer& a) const {
+        BigInteger r = a % this->m;
+        if (r.limbs.negative()) {
+            r += this->m;
+        }
+        return r;
+    }
 
-        return *this;
+    // Copies a < m into n limbs.
+    void store(Limb* r, const BigInteger& a) const {
+        std::copy(a.limbs.data(), a.limbs.data() + a.limbs.size(), r);
+        std::fill(r + a.limbs.size(), r + this->n, 0);
     }
 
-    friend BigInteger operator-(BigInteger lhs, const BigInteger& rhs) {
-        lhs -= rhs;
-        return lhs;
+    std::size_t scratchSize() const {
+        return this->n >= detail::REDC_THRESHOLD ? 7 * this->n : 3 * this->n;
     }
 
-    BigInteger& operator*=(const BigInteger& rhs) {
-        BigInteger result;
+    // r = a b / R mod m on n limbs, r may alias a or b.
+    void multiplyLimbs(Limb* r, const Limb* a, const Limb* b,
+                       Limb* scratch) const {
+        detail::mul(scratch, a, this->n, b, this->n);
+        reduceLimbs(scratch + 2 * this->n, scratch, scratch + 3 * this->n);
+        std::copy(scratch + 2 * this->n, scratch + 3 * this->n, r);
+    }
 
-        if ((this->negative && !rhs.negative) ||
-            (!this->negative && rhs.negative)) {
-            result.negative = true;
+    // r = t / R mod m for the 2n limbs t, which are clobbered.
+    void reduceLimbs(Limb* r, Limb* t, Limb* scratch) const {
+        if (this->n >= detail::REDC_THRESHOLD) {
+            detail::redcMul(r, t, this->m.limbs.data(), this->n,
+                            this->mNegInverse.data(), scratch);
         }
         else {
-            result.negative = false;
+            detail::redcBasecase(r, t, this->m.limbs.data(), this->n,
+                                 this->mInverse);
         }
+    }
 
-        int m = this->integral.size();
-        int n = rhs.integral.size();
+    BigInteger reduce(std::vector<Limb>& t) const {
+        std::vector<Limb> r(this->n);
+        std::vector<Limb> scratch(this->n >= detail::REDC_THRESHOLD ?
+                                  4 * this->n : 0);
+        reduceLimbs(r.data(), t.data(), scratch.data());
+        return BigInteger(limbsOf(r.data(), this->n));
+    }
+};
 
-        result.integral = std::vector<int>(m + n);
+/*
+ * Reduction by a fixed positive modulus m of n limbs with Barrett's method
+ * (Handbook of Applied Cryptography, Algorithm 14.42). The reciprocal
+ * mu = 2^(128 n) / m is computed once, after which a value of up to 2n limbs
+ * is reduced with two multiplications and at most two subtractions of m
+ * instead of a division. Longer values are reduced n limbs at a time.
+ *
+ * Unlike MontgomeryContext it works for even moduli and on the usual
+ * representation. A reducer is immutable once built and can be shared by
+ * several threads.
+ */
+class BarrettReducer {
 
-        int j = 0;
+public:
+    typedef detail::Limb Limb;
 
-        while (j < n) {
-            if (rhs.integral[j] == 0) {
-                result.integral[j + m] = 0;
-            }
+    explicit BarrettReducer(const BigInteger& modulus) :
+        m{modulus}, n{modulus.limbs.size()} {
+        if (this->m.limbs.negative() || this->m.limbs.empty()) {
+            throw std::invalid_argument(
+                "BarrettReducer: the modulus must be positive");
+        }
 
-            int i = 0;
-            int k = 0;
+        detail::LimbVector power(2 * this->n + 1);
+        power[2 * this->n] = 1;
+        this->mu = BigInteger(std::move(power)) / this->m;
+    }
 
-            while (i < m) {
-                int t = this->integral[i] * rhs.integral[j]
-                    + result.integral[i + j] + k;
-                result.integral[i + j] = t % 10;
-                k = std::floor(t / 10.0);
-                i++;
-            }
+    const BigInteger& modulus() const {
+        return this->m;
+    }
 
-            result.integral[j + m] = k;
+    // a mod m in [0, m), negative values included.
+    BigInteger reduce(const BigInteger& a) const {
+        BigInteger r;
+        reduce(a, r);
+        return r;
+    }
+
+    // r = a mod m, reusing the limbs of r. r may alias a.
+    void reduce(const BigInteger& a, BigInteger& r) const {
+        std::vector<Limb> scratch(scratchSize());
+        reduce(a, r, scratch.data());
+    }
 
-            j++;
+    /*
+     * results[i] = values[i] mod m for count values. The scratch limbs are
+     * allocated once for the whole batch and every result reuses its own
+     * limbs, so reducing into the same results again allocates nothing
+     * else. results may alias values.
+     */
+    void reduce(const BigInteger* values, BigInteger* results,
+                std::size_t count) const {
+        std::vector<Limb> scratch(scratchSize());
+        for (std::size_t i = 0; i < count; i++) {
+            reduce(values[i], results[i], scratch.data());
         }
+    }
 
-        removeIntegralLeadingZeroes(result.integral);
+    template <class Allocator1, class Allocator2>
+    void reduce(const std::vector<BigInteger, Allocator1>& values,
+                std::vector<BigInteger, Allocator2>& results) const {
+        results.resize(values.size());
+        reduce(values.data(), results.data(), values.size());
+    }
 
-        *this = result;
-        return *this;
+#ifdef BIGNUMERICS_HAS_SPAN
+    // results holds at least as many values as values.
+    void reduce(std::span<const BigInteger> values,
+                std::span<BigInteger> results) const {
+        reduce(values.data(), results.data(), values.size());
     }
+#endif
 
-    friend BigInteger operator*(BigInteger lhs, BigInteger rhs) {
-        lhs *= rhs;
-        return lhs;
+    // a b mod m.
+    BigInteger multiply(const BigInteger& a, const BigInteger& b) const {
+        BigInteger r = a * b;
+        reduce(r, r);
+        return r;
     }
 
-    BigInteger& operator/=(const BigInteger& rhs) {
-        if (rhs == BigInteger("0")) {
-            *this = BigInteger("nan");
-            return *this;
-        }
+    BigInteger square(const BigInteger& a) const {
+        BigInteger r = a.square();
+        reduce(r, r);
+        return r;
+    }
 
-        if (rhs > *this) {
-            *this = BigInteger("0");
-            return *this;
-        }
+private:
+    BigInteger m;
+    std::size_t n;
+    BigInteger mu;
+
+    /*
+     * Room for q1 mu, q3 m, the n + 1 limbs of x - q3 m, the remainder and
+     * the 2n limbs of a Horner step.
+     */
+    std::size_t scratchSize() const {
+        return 8 * this->n + 6;
+    }
 
-        if (this->negative || rhs.negative) {
-            this->negative = true;
+    void reduce(const BigInteger& a, BigInteger& r, Limb* scratch) const {
+        std::size_t an = a.limbs.size();
+        bool negative = a.limbs.negative();
+        if (an < this->n || (an == this->n &&
+                             detail::cmp(a.limbs.data(), this->m.limbs.data(),
+                                         an) < 0)) {
+            if (&r != &a) {
+                r.limbs.assign(a.limbs.data(), an);
+            }
         }
         else {
-            this->negative = false;
+            Limb* remainder = scratch + 5 * this->n + 6;
+            reduceLimbs(remainder, a.limbs.data(), an, scratch);
+            r.limbs.assign(remainder,
+                           detail::normalizedSize(remainder, this->n));
         }
 
-        if (rhs == *this) {
-            *this = BigInteger("1");
-            return *this;
+        r.limbs.setNegative(false);
+        if (negative && !r.limbs.empty()) {
+            r.limbs.resize(this->n);
+            detail::sub(r.limbs.data(), this->m.limbs.data(), this->n,
+                        r.limbs.data(), this->n);
+            BigInteger::removeLeadingZeroLimbs(r.limbs);
+        }
+    }
+
+    // r = x mod m on n limbs for any xn >= n.
+    void reduceLimbs(Limb* r, const Limb* x, std::size_t xn,
+                     Limb* scratch) const {
+        std::size_t n = this->n;
+        if (xn <= 2 * n) {
+            reduceDouble(r, x, xn, scratch);
+            return;
         }
 
-        BigInteger u = *this;
-        BigInteger v = rhs;
+        // Horner's rule over the lower limbs, n at a time: each step reduces
+        // the previous remainder shifted above the next limbs.
+        Limb* t = scratch + 6 * n + 6;
+        reduceDouble(r, x + xn - 2 * n, 2 * n, scratch);
+        for (std::size_t p = xn - 2 * n; p > 0;) {
+            std::size_t k = std::min(n, p);
+            p -= k;
+            std::copy(x + p, x + p + k, t);
+            std::copy(r, r + n, t + k);
+            reduceDouble(r, t, k + n, scratch);
+        }
+    }
 
-        unsigned long long int m = u.integral.size() - v.integral.size();
-        unsigned long long int n = v.integral.size();
+    /*
+     * r = x mod m on n limbs for n <= xn <= 2n: with q1 = x / 2^(64 (n - 1))
+     * the estimate q3 = q1 mu / 2^(64 (n + 1)) falls short of x / m by at
+     * most two, so x - q3 m < 3m fits in n + 1 limbs and is computed modulo
+     * 2^(64 (n + 1)).
+     */
+    void reduceDouble(Limb* r, const Limb* x, std::size_t xn,
+                      Limb* scratch) const {
+        std::size_t n = this->n;
+        const Limb* mp = this->m.limbs.data();
+        const Limb* q1 = x + n - 1;
+        std::size_t q1n = detail::normalizedSize(q1, xn - n + 1);
+        std::size_t mun = this->mu.limbs.size();
 
-        BigInteger q;
-        q.integral = std::vector<int>(m+1);
+        Limb* q2 = scratch;
+        Limb* q3m = scratch + 2 * n + 3;
+        Limb* t = scratch + 4 * n + 5;
 
-        if ((!u.negative && v.negative) || (u.negative && !v.negative)) {
-            q.negative = true;
+        std::fill(t, t + n + 1, 0);
+        std::copy(x, x + std::min(xn, n + 1), t);
+        if (q1n + mun > n + 1 && n < detail::KARATSUBA_THRESHOLD) {
+            // Below Karatsuba only the needed halves of both products are
+            // computed. Leaving out the columns of q1 mu below n - 1 lowers
+            // q3 by at most one more, x - q3 m < 4m still fits.
+            detail::mulHighBasecase(q2, this->mu.limbs.data(), mun, q1, q1n,
+                                    n - 1);
+            const Limb* q3 = q2 + n + 1;
+            std::size_t q3n = detail::normalizedSize(q3, q1n + mun - n - 1);
+            detail::mulLowBasecase(q3m, mp, n, q3, q3n, n + 1);
+            detail::subN(t, t, q3m, n + 1);
         }
+        else if (q1n + mun > n + 1) {
+            if (q1n >= mun) {
+                detail::mul(q2, q1, q1n, this->mu.limbs.data(), mun);
+            }
+            else {
+                detail::mul(q2, this->mu.limbs.data(), mun, q1, q1n);
+            }
 
-        if (n == 1) {
-            long long int j = u.integral.size() - 1;
-            int r = 0;
-
-            while (j >= 0) {
-                int w_j = std::floor(( r * 10 + u.integral[j]) / v.integral[0]);
-                r = ( r * 10 + u.integral[j]) % v.integral[0];
-                q.integral[j] = w_j;
-                j--;
+            const Limb* q3 = q2 + n + 1;
+            std::size_t q3n = detail::normalizedSize(q3, q1n + mun - n - 1);
+            if (q3n != 0) {
+                if (q3n >= n) {
+                    detail::mul(q3m, q3, q3n, mp, n);
+                }
+                else {
+                    detail::mul(q3m, mp, n, q3, q3n);
+                }
+                detail::subN(t, t, q3m, n + 1);
             }
+        }
+
+        while (t[n] != 0 || detail::cmp(t, mp, n) >= 0) {
+            t[n] -= detail::subN(t, t, mp, n);
+        }
+        std::copy(t, t + n, r);
+    }
+};
 
-            removeIntegralLeadingZeroes(q.integral);
+namespace detail {
 
-            *this = q;
-            return *this;
+/*
+ * base^e mod m for the bits long exponent e, bits > 0, and a base already
+ * reduced by the reducer of m.
+ */
+inline BigInteger powmodBarrett(const BarrettReducer& reducer,
+                                const BigInteger& base, const Limb* e,
+                                std::size_t bits) {
+    // powers holds base^1, base^3, ... base^(2^window - 1) mod m.
+    std::size_t window = powmodWindow(bits);
+    std::vector<BigInteger> powers((std::size_t)1 << (window - 1));
+    powers[0] = base;
+    if (window > 1) {
+        BigInteger square = reducer.square(powers[0]);
+        for (std::size_t i = 1; i < powers.size(); i++) {
+            powers[i] = reducer.multiply(powers[i - 1], square);
         }
+    }
 
-        // D1
-        int d = std::floor(10.0 / (rhs.integral[rhs.integral.size() - 1] + 1));
-        BigInteger D(std::to_string(d));
+    auto bit = [e](std::size_t i) {
+        return (e[i / LIMB_BITS] >> (i % LIMB_BITS)) & 1;
+    };
 
-        u *= D;
-        u.integral.push_back(0);
-        v *= D;
+    BigInteger x;
+    bool first = true;
+    for (std::size_t i = bits; i > 0;) {
+        if (bit(i - 1) == 0) {
+            x = reducer.square(x);
+            i--;
+            continue;
+        }
 
-        // D2
-        long long int j = m;
+        // The longest window of at most window bits ending on a one.
+        std::size_t low = i > window ? i - window : 0;
+        while (bit(low) == 0) {
+            low++;
+        }
+        std::size_t value = 0;
+        for (std::size_t j = i; j > low; j--) {
+            value = 2 * value + bit(j - 1);
+        }
 
-        while (j >= 0) {
-            // D3
-            int q_hat = std::floor((u.integral[j + n] * 10.0 +
-                        u.integral[j + n - 1]) / (double)v.integral[n - 1]);
+        if (first) {
+            x = powers[value / 2];
+            first = false;
+        }
+        else {
+            for (std::size_t j = low; j < i; j++) {
+                x = reducer.square(x);
+            }
+            x = reducer.multiply(x, powers[value / 2]);
+        }
+        i = low;
+    }
+    return x;
+}
 
-            int r_hat = (u.integral[j + n] * 10 + u.integral[j + n - 1]) %
-                v.integral[n - 1];
+} /* namespace detail */
 
-            if ((q_hat >= 10) || (q_hat * v.integral[n - 2] >
-                10 * r_hat + u.integral[j + n - 2])) {
-                q_hat--;
-                r_hat += v.integral[n-1];
+/*
+ * base^exponent mod modulus for a positive modulus, the result lies in
+ * [0, modulus). A negative exponent raises the inverse of base, see
+ * modinv(). Odd moduli go through a MontgomeryContext and even ones through
+ * a BarrettReducer with the same sliding windows, build one yourself to
+ * reuse it across calls.
+ */
+inline BigInteger powmod(const BigInteger& base, const BigInteger& exponent,
+                         const BigInteger& modulus) {
+    if (modulus.limbs.negative() || modulus.limbs.empty()) {
+        throw std::domain_error("BigInteger: the modulus must be positive");
+    }
 
-                while (r_hat < 10) {
-                    if ((q_hat >= 10) || (q_hat * v.integral[n - 2] >
-                        10 * r_hat + u.integral[j + n - 2])) {
-                        q_hat--;
-                        r_hat += v.integral[n-1];
-                    }
-                    else {
-                        break;
-                    }
-                }
-            }
+    if (exponent.limbs.negative()) {
+        return powmod(modinv(base, modulus), -exponent, modulus);
+    }
 
-            // D4
-            std::vector<int> a(u.integral.begin() + j, u.integral.begin() + j + n + 1);
-            BigInteger tempU(a);
-            tempU -= BigInteger(std::to_string(q_hat)) * v;
+    if (modulus.limbs[0] % 2 == 1) {
+        return MontgomeryContext(modulus).powmod(base, exponent);
+    }
 
-            bool resultOfStepD4Negative = tempU.negative;
-            if (resultOfStepD4Negative) {
-                BigInteger complement("10");
-                for (long long int i = 0; i < n+1; i++) {
-                    complement *= BigInteger("10");
-                }
-                tempU += complement;
-            }
+    BarrettReducer reducer(modulus);
+    std::size_t bits = BigInteger::bitLength(exponent);
+    if (bits == 0) {
+        return reducer.reduce(BigInteger::one());
+    }
+    return detail::powmodBarrett(reducer, reducer.reduce(base),
+                                 exponent.limbs.data(), bits);
+}
 
-            while (tempU.integral.size() < n+1) {
-                tempU.integral.push_back(0);
-            }
+#ifdef BIGNUMERICS_LITTLE_ENDIAN
+/*
+ * A read-only BigInteger over limbs it does not own, typically those of a
+ * serialized record inside a memory-mapped file or a network buffer, which
+ * it uses in place without copying. The bytes must outlive the view and
+ * the limbs of the record must be 8-byte aligned, as they are for records
+ * packed into an aligned buffer. Only available on little-endian hosts,
+ * where the record limbs are native limbs.
+ *
+ * A view is a read-only operand: +, -, *, / and %, the compound
+ * assignments of BigInteger, divmod(), gcd() and powmod() take views and
+ * BigIntegers alike and read the limbs of views where they lie. Views also
+ * compare with each other and with BigIntegers, toBigInteger() copies the
+ * value out.
+ */
+class BigIntegerView {
 
-            for (long long int i = j; i <= j + n; i++) {
-                u.integral[i] = tempU.integral[i-j];
-            }
+public:
+    typedef detail::Limb Limb;
 
-            // D5
-            unsigned long long int q_j = q_hat;
+    // Views the record at the start of the size bytes of data.
+    BigIntegerView(const unsigned char* data, std::size_t size) {
+        detail::SerialRecord record = detail::readSerialRecord(
+            data, size, "BigIntegerView");
+        if (record.decimal) {
+            throw std::invalid_argument(
+                "BigIntegerView: the record holds a BigDecimal");
+        }
+        if (reinterpret_cast<std::uintptr_t>(record.limbs) %
+            alignof(Limb) != 0) {
+            throw std::invalid_argument(
+                "BigIntegerView: the limbs are not 8-byte aligned");
+        }
 
-            if (resultOfStepD4Negative) {
-                // D6
-                q_j--;
+        this->limbs = reinterpret_cast<const Limb*>(record.limbs);
+        this->n = record.n;
+        this->isNegative = record.negative;
+    }
 
-                std::vector<int> uJtoJN(n+1);
-                std::copy(u.integral.begin() + j,
-                          u.integral.begin() + j + n + 1,
-                          uJtoJN.begin());
-                tempU = BigInteger(uJtoJN);
-                tempU += v;
+    // Views the limbs of n, which must outlive the view.
+    BigIntegerView(const BigInteger& n) :
+        limbs{n.limbs.data()}, n{n.limbs.size()},
+        isNegative{n.limbs.negative()} {}
 
-                std::copy(tempU.integral.begin(), tempU.integral.begin() + n,
-                          u.integral.begin() + j);
-            }
+    const Limb* data() const {
+        return this->limbs;
+    }
 
-            q.integral[j] = q_j;
+    std::size_t size() const {
+        return this->n;
+    }
 
-            // D7
-            j--;
-        }
+    bool negative() const {
+        return this->isNegative;
+    }
 
-        removeIntegralLeadingZeroes(q.integral);
-        
-        // D8
-        *this = q;
-        return *this;
+    // Bytes taken by the record, to step to the next one in a buffer.
+    std::size_t serializedSize() const {
+        return detail::SERIAL_HEADER_SIZE + this->n * sizeof(Limb);
     }
 
-    friend BigInteger operator/(BigInteger lhs, BigInteger rhs) {
-        lhs /= rhs;
-        return lhs;
+    // Number of bits of the magnitude, 0 for zero.
+    std::size_t bitLength() const {
+        return this->n == 0 ? 0 : this->n * detail::LIMB_BITS -
+            (std::size_t)__builtin_clzll(this->limbs[this->n - 1]);
     }
 
-    friend inline bool operator==(const BigInteger& l, const BigInteger& r) {
-        if (l.integral.size() != r.integral.size()) {
-            return false;
-        }
+    BigInteger toBigInteger() const {
+        BigInteger r(this->limbs, this->n);
+        return this->isNegative ? -r : r;
+    }
 
-        for (size_t i = 0; i < l.integral.size(); i++) {
-            if (l.integral[i] != r.integral[i]) {
-                return false;
-            }
-        }
+    std::string toString() const {
+        std::string s = detail::toDecimal(this->limbs, this->n);
+        return this->isNegative ? "-" + s : s;
+    }
 
-        return true;
+    friend std::ostream& operator<<(std::ostream& os,
+                                    const BigIntegerView& v) {
+        return os << v.toString();
     }
 
-    friend inline bool operator!=(const BigInteger& l, const BigInteger& r) {
+    friend inline bool operator==(const BigIntegerView& l,
+                                  const BigIntegerView& r) {
+        return l.isNegative == r.isNegative && l.n == r.n &&
+            detail::cmp(l.limbs, r.limbs, l.n) == 0;
+    }
+
+    friend inline bool operator!=(const BigIntegerView& l,
+                                  const BigIntegerView& r) {
         return !operator==(l, r);
     }
 
-    friend inline bool operator<(const BigInteger& l, const BigInteger& r) {
-        if (l.negative && !r.negative) {
-            return true;
-        }
-        if (!l.negative && r.negative) {
-            return false;
-        }
-        if (l.integral.size() != r.integral.size()) {
-            if (l.negative && r.negative) {
-                return l.integral.size() > r.integral.size();
-            }
-            if (!l.negative && !r.negative) {
-                return l.integral.size() < r.integral.size();
-            }
+    friend inline bool operator<(const BigIntegerView& l,
+                                 const BigIntegerView& r) {
+        if (l.isNegative != r.isNegative) {
+            return l.isNegative;
         }
 
-        for (int i = (int)l.integral.size() - 1; i >= 0; i--) {
-            if (l.integral[i] < r.integral[i]) {
-                if (!l.negative && !r.negative) {
-                    return true;
-                }
-                else {
-                    return false;
-                }
-            }
-            else if (l.integral[i] > r.integral[i]){
-                if (!l.negative && !r.negative) {
-                    return false;
-                }
-                else {
-                    return true;
-                }
-            }
-        }
+        int c = l.n != r.n ? (l.n < r.n ? -1 : 1) :
+            detail::cmp(l.limbs, r.limbs, l.n);
 
-        return false;
+        return l.isNegative ? c > 0 : c < 0;
     }
 
-    friend inline bool operator>(const BigInteger& l, const BigInteger& r) {
+    friend inline bool operator>(const BigIntegerView& l,
+                                 const BigIntegerView& r) {
         return operator<(r, l);
     }
 
-    friend inline bool operator<=(const BigInteger& l, const BigInteger& r) {
+    friend inline bool operator<=(const BigIntegerView& l,
+                                  const BigIntegerView& r) {
         return !operator>(l, r);
     }
 
-    friend inline bool operator>=(const BigInteger& l, const BigInteger& r) {
+    friend inline bool operator>=(const BigIntegerView& l,
+                                  const BigIntegerView& r) {
         return !operator<(l, r);
     }
 
-    friend std::ostream& operator<<(std::ostream& os, const BigInteger& bI) {
-        if (bI.negative) {
-            os << '-';
-        }
+    // Also takes a BigInteger on either side, which converts to a view.
+    friend BigInteger operator+(const BigIntegerView& l,
+                                const BigIntegerView& r) {
+        BigInteger sum = l.toBigInteger();
+        sum += r;
+        return sum;
+    }
 
-        for (int i = bI.integral.size() - 1; i >= 0; i--) {
-            os << bI.integral[i];
-        }
+    friend BigInteger operator-(const BigIntegerView& l,
+                                const BigIntegerView& r) {
+        BigInteger difference = l.toBigInteger();
+        difference -= r;
+        return difference;
+    }
 
-        if (bI.integral.size() == 0) {
-            os << '0';
-        }
-        return os;
+    friend BigInteger operator*(const BigIntegerView& l,
+                                const BigIntegerView& r) {
+        return multiply(l, r);
+    }
+
+    friend BigInteger operator/(const BigIntegerView& l,
+                                const BigIntegerView& r) {
+        BigInteger quotient;
+        BigInteger remainder;
+        BigInteger::divmod(l, r, quotient, remainder);
+        return quotient;
+    }
+
+    friend BigInteger operator%(const BigIntegerView& l,
+                                const BigIntegerView& r) {
+        BigInteger quotient;
+        BigInteger remainder;
+        BigInteger::divmod(l, r, quotient, remainder);
+        return remainder;
     }
 
 private:
-    std::vector<int> integral;
-    bool negative;
+    const Limb* limbs;
+    std::size_t n;
+    bool isNegative;
 
-    static void removeIntegralLeadingZeroes(std::vector<int>& v) {
-        if (v.empty()) {
-            return;
+    static BigInteger multiply(const BigIntegerView& l,
+                               const BigIntegerView& r) {
+        BigInteger product;
+        if (l.n != 0 && r.n != 0) {
+            product.limbs.resize(l.n + r.n);
+            BigInteger::multiplyMagnitudes(product.limbs.data(), l.limbs, l.n,
+                                           r.limbs, r.n);
+            BigInteger::removeLeadingZeroLimbs(product.limbs);
+            product.limbs.setNegative(l.isNegative != r.isNegative);
         }
+        return product;
+    }
+};
 
-        auto nonZeroIndex = 0;
-        for (int i = v.size() - 1; i >= 0; i--) {
-            if (v[i] != 0) {
-                nonZeroIndex = i;
-                break;
-            }
-        }
+inline BigInteger& BigInteger::operator+=(const BigIntegerView& rhs) {
+    addSigned(rhs.data(), rhs.size(), rhs.negative());
+    return *this;
+}
+
+inline BigInteger& BigInteger::operator-=(const BigIntegerView& rhs) {
+    addSigned(rhs.data(), rhs.size(), !rhs.negative());
+    return *this;
+}
+
+inline BigInteger& BigInteger::operator*=(const BigIntegerView& rhs) {
+    multiplyBy(rhs.data(), rhs.size(), rhs.negative());
+    return *this;
+}
+
+inline BigInteger& BigInteger::operator/=(const BigIntegerView& rhs) {
+    BigInteger remainder(detail::LimbVector(this->limbs.memoryResource()));
+    divideLimbs(this->limbs.data(), this->limbs.size(),
+                this->limbs.negative(), rhs.data(), rhs.size(),
+                rhs.negative(), *this, remainder);
+    return *this;
+}
+
+inline BigInteger& BigInteger::operator%=(const BigIntegerView& rhs) {
+    BigInteger quotient(detail::LimbVector(this->limbs.memoryResource()));
+    divideLimbs(this->limbs.data(), this->limbs.size(),
+                this->limbs.negative(), rhs.data(), rhs.size(),
+                rhs.negative(), quotient, *this);
+    return *this;
+}
 
-        v.erase(v.begin() + nonZeroIndex + 1, v.end());
+inline void BigInteger::divmod(const BigIntegerView& a,
+                               const BigIntegerView& b,
+                               BigInteger& q, BigInteger& r) {
+    divideLimbs(a.data(), a.size(), a.negative(), b.data(), b.size(),
+                b.negative(), q, r);
+}
+
+// gcd(a, b) with the limbs of views read in place.
+inline BigInteger gcd(const BigIntegerView& a, const BigIntegerView& b) {
+    detail::SignedLimbs x(a.data(), a.size());
+    detail::SignedLimbs y(b.data(), b.size());
+    detail::gcdReduce(x, y, nullptr);
+    return BigInteger::fromSignedLimbs(x);
+}
+
+inline BigInteger MontgomeryContext::powmod(
+    const BigIntegerView& base, const BigIntegerView& exponent) const {
+    if (exponent.negative()) {
+        return powmod(base.toBigInteger(), exponent.toBigInteger());
     }
 
-    static void appendZeroes(std::vector<int>& v, long long int d) {
-        for (long long int i = 0; i < d; i++) {
-            v.push_back(0);
-        }
+    std::size_t bits = exponent.bitLength();
+    if (bits == 0) {
+        return BigInteger::one() % this->m;
     }
+    return powmodBits(multiply(residue(base), this->r2), exponent.data(),
+                      bits);
+}
 
-    static unsigned long long int countLeadingZeroes(const std::vector<int>& v) {
-        unsigned long long int numberOfZeroes = 0;
-        for (unsigned long long int i = 0; i < v.size(); i++) {
-            if (v[i] != 0) {
-                break;
-            }
-            numberOfZeroes++;
-        }
-        return numberOfZeroes;
+/*
+ * powmod() with the limbs of views read in place. The modulus is copied
+ * once into the MontgomeryContext or BarrettReducer.
+ */
+inline BigInteger powmod(const BigIntegerView& base,
+                         const BigIntegerView& exponent,
+                         const BigIntegerView& modulus) {
+    if (modulus.negative() || modulus.size() == 0) {
+        throw std::domain_error("BigInteger: the modulus must be positive");
+    }
+
+    if (exponent.negative()) {
+        return powmod(base.toBigInteger(), exponent.toBigInteger(),
+                      modulus.toBigInteger());
     }
 
-    static int positiveModulo(int i, int n) {
-        return (i % n + n) % n;
+    if (modulus.data()[0] % 2 == 1) {
+        return MontgomeryContext(modulus.toBigInteger()).powmod(base,
+                                                                exponent);
     }
+
+    BarrettReducer reducer(modulus.toBigInteger());
+    std::size_t bits = exponent.bitLength();
+    if (bits == 0) {
+        return reducer.reduce(BigInteger::one());
+    }
+    return detail::powmodBarrett(reducer, reducer.reduce(base % modulus),
+                                 exponent.data(), bits);
+}
+#endif
+
+#if __cplusplus >= 201402L
+namespace detail {
+
+// The limbs of an integer literal, parsed at compile time.
+template <std::size_t N>
+struct LiteralLimbs {
+    Limb limbs[N];
+    std::size_t size;
 };
 
+// Value of a digit in bases up to 16, 16 for anything else.
+constexpr unsigned literalDigit(char c) {
+    return c >= '0' && c <= '9' ? (unsigned)(c - '0') :
+        c >= 'a' && c <= 'f' ? (unsigned)(c - 'a' + 10) :
+        c >= 'A' && c <= 'F' ? (unsigned)(c - 'A' + 10) : 16;
+}
+
+// r = r base + digit.
+template <std::size_t N>
+constexpr void appendLiteralDigit(LiteralLimbs<N>& r, unsigned base,
+                                  unsigned digit) {
+    Limb carry = digit;
+    for (std::size_t i = 0; i < r.size; i++) {
+        DoubleLimb t = (DoubleLimb)r.limbs[i] * base + carry;
+        r.limbs[i] = (Limb)t;
+        carry = (Limb)(t >> LIMB_BITS);
+    }
+    if (carry != 0) {
+        r.limbs[r.size++] = carry;
+    }
+}
+
+/*
+ * Parses the characters of an integer literal the way the compiler does:
+ * decimal, or hexadecimal, binary and octal after 0x, 0b and 0, with digit
+ * separators. A character outside of the base throws, which makes the
+ * constant evaluation and so the compilation fail. N bounds the limbs of
+ * any base up to 16 as 4 bits per character.
+ */
+template <char... Chars>
+constexpr LiteralLimbs<(sizeof...(Chars) * 4 + LIMB_BITS - 1) / LIMB_BITS>
+parseIntegerLiteral() {
+    const char chars[] = {Chars...};
+    const std::size_t count = sizeof...(Chars);
+    LiteralLimbs<(sizeof...(Chars) * 4 + LIMB_BITS - 1) / LIMB_BITS> r{};
+
+    unsigned base = 10;
+    std::size_t i = 0;
+    if (count > 1 && chars[0] == '0') {
+        if (chars[1] == 'x' || chars[1] == 'X') {
+            base = 16;
+            i = 2;
+        }
+        else if (chars[1] == 'b' || chars[1] == 'B') {
+            base = 2;
+            i = 2;
+        }
+        else {
+            base = 8;
+            i = 1;
+        }
+    }
+
+    for (; i < count; i++) {
+        if (chars[i] == '\'') {
+            continue;
+        }
+        unsigned digit = literalDigit(chars[i]);
+        if (digit >= base) {
+            throw std::invalid_argument("BigInteger: invalid literal");
+        }
+        appendLiteralDigit(r, base, digit);
+    }
+    return r;
+}
+
+} /* namespace detail */
+
+namespace literals {
+
+/*
+ * 123456789012345678901234567890_bi, after using namespace
+ * BigNumerics::literals. The literal is converted to limbs at compile time,
+ * at run time it only copies them.
+ */
+template <char... Chars>
+BigInteger operator""_bi() {
+    static constexpr auto literal = detail::parseIntegerLiteral<Chars...>();
+    return BigInteger(literal.limbs, literal.size);
+}
+
+} /* namespace literals */
+#endif
+
 } /* namespace BigInteger */
+
+#endif
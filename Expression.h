@@ -0,0 +1,252 @@
+#ifndef BIGNUMERICS_EXPRESSION_H
+#define BIGNUMERICS_EXPRESSION_H
+
+#include <string>
+#include <utility>
+
+namespace BigNumerics {
+
+namespace expression {
+
+/*
+ * Lazy sums of products over BigInteger and BigDecimal. a * b yields a
+ * Product and adding or subtracting products and numbers builds a Sum, so a
+ * statement like x = a * b + c * d - e evaluates into x with one fused
+ * multiply-accumulate per product and no intermediate numbers.
+ *
+ * Nodes are small and copied by value but refer to the numbers they were
+ * built from. Only named numbers are held by reference: a product or a sum
+ * with a temporary operand is evaluated right away instead. An expression
+ * over named numbers may outlive the statement that builds it only as long
+ * as these numbers are alive and unchanged.
+ *
+ * A number type T takes part by providing addmul(a, b) and submul(a, b)
+ * besides += and -=.
+ */
+template <class T, class E>
+class Expression {
+
+public:
+    const E& self() const {
+        return static_cast<const E&>(*this);
+    }
+
+    T evaluate() const {
+        T result;
+        self().accumulate(result, false);
+        return result;
+    }
+
+    operator T() const {
+        return evaluate();
+    }
+
+    std::string toString() const {
+        return evaluate().toString();
+    }
+};
+
+template <class T>
+class Operand : public Expression<T, Operand<T>> {
+
+public:
+    explicit Operand(const T& value) : value(value) {}
+
+    // dest += value, or dest -= value when negate is set.
+    void accumulate(T& dest, bool negate) const {
+        if (negate) {
+            dest -= this->value;
+        }
+        else {
+            dest += this->value;
+        }
+    }
+
+    bool references(const T* p) const {
+        return &this->value == p;
+    }
+
+    bool leadsWith(const T* p) const {
+        return &this->value == p;
+    }
+
+    bool referencesAfterLead(const T*) const {
+        return false;
+    }
+
+    void accumulateAfterLead(T&, bool) const {}
+
+private:
+    const T& value;
+};
+
+template <class T>
+class Product : public Expression<T, Product<T>> {
+
+public:
+    Product(const T& a, const T& b) : a(a), b(b) {}
+
+    void accumulate(T& dest, bool negate) const {
+        if (negate) {
+            dest.submul(this->a, this->b);
+        }
+        else {
+            dest.addmul(this->a, this->b);
+        }
+    }
+
+    bool references(const T* p) const {
+        return &this->a == p || &this->b == p;
+    }
+
+    bool leadsWith(const T*) const {
+        return false;
+    }
+
+    bool referencesAfterLead(const T* p) const {
+        return references(p);
+    }
+
+    void accumulateAfterLead(T& dest, bool negate) const {
+        accumulate(dest, negate);
+    }
+
+private:
+    const T& a;
+    const T& b;
+};
+
+template <class T, class L, class R, bool Subtract>
+class Sum : public Expression<T, Sum<T, L, R, Subtract>> {
+
+public:
+    Sum(const L& left, const R& right) : left(left), right(right) {}
+
+    void accumulate(T& dest, bool negate) const {
+        this->left.accumulate(dest, negate);
+        this->right.accumulate(dest, negate != Subtract);
+    }
+
+    bool references(const T* p) const {
+        return this->left.references(p) || this->right.references(p);
+    }
+
+    bool leadsWith(const T* p) const {
+        return this->left.leadsWith(p);
+    }
+
+    bool referencesAfterLead(const T* p) const {
+        return this->left.referencesAfterLead(p) || this->right.references(p);
+    }
+
+    void accumulateAfterLead(T& dest, bool negate) const {
+        this->left.accumulateAfterLead(dest, negate);
+        this->right.accumulate(dest, negate != Subtract);
+    }
+
+private:
+    L left;
+    R right;
+};
+
+/*
+ * dest = e updating dest in place when e starts with dest itself and does
+ * not refer to it afterwards, as in x = x + a * b. Returns false when dest
+ * has to be rebuilt instead.
+ */
+template <class T, class E>
+bool updateInPlace(T& dest, const Expression<T, E>& e) {
+    if (!e.self().leadsWith(&dest) || e.self().referencesAfterLead(&dest)) {
+        return false;
+    }
+
+    e.self().accumulateAfterLead(dest, false);
+    return true;
+}
+
+/*
+ * dest += e, or dest -= e when negate is set. When dest also appears inside
+ * e the expression is evaluated on the side first.
+ */
+template <class T, class E>
+void accumulate(T& dest, const Expression<T, E>& e, bool negate) {
+    if (e.self().references(&dest)) {
+        T value = e.evaluate();
+        Operand<T>(value).accumulate(dest, negate);
+        return;
+    }
+
+    e.self().accumulate(dest, negate);
+}
+
+template <class T, class L, class R>
+Sum<T, L, R, false> operator+(const Expression<T, L>& l,
+                              const Expression<T, R>& r) {
+    return Sum<T, L, R, false>(l.self(), r.self());
+}
+
+template <class T, class L, class R>
+Sum<T, L, R, true> operator-(const Expression<T, L>& l,
+                             const Expression<T, R>& r) {
+    return Sum<T, L, R, true>(l.self(), r.self());
+}
+
+template <class T, class L>
+Sum<T, L, Operand<T>, false> operator+(const Expression<T, L>& l,
+                                       const T& r) {
+    return Sum<T, L, Operand<T>, false>(l.self(), Operand<T>(r));
+}
+
+template <class T, class L>
+Sum<T, L, Operand<T>, true> operator-(const Expression<T, L>& l,
+                                      const T& r) {
+    return Sum<T, L, Operand<T>, true>(l.self(), Operand<T>(r));
+}
+
+template <class T, class R>
+Sum<T, Operand<T>, R, false> operator+(const T& l,
+                                       const Expression<T, R>& r) {
+    return Sum<T, Operand<T>, R, false>(Operand<T>(l), r.self());
+}
+
+template <class T, class R>
+Sum<T, Operand<T>, R, true> operator-(const T& l,
+                                      const Expression<T, R>& r) {
+    return Sum<T, Operand<T>, R, true>(Operand<T>(l), r.self());
+}
+
+/*
+ * With a temporary number on either side the sum is evaluated into it, so
+ * that no node refers to a number that dies with the statement. T&& only
+ * deduces the same T as the expression for rvalues.
+ */
+template <class T, class L>
+T operator+(const Expression<T, L>& l, T&& r) {
+    accumulate(r, l, false);
+    return std::move(r);
+}
+
+template <class T, class L>
+T operator-(const Expression<T, L>& l, T&& r) {
+    T result = l.evaluate();
+    result -= r;
+    return result;
+}
+
+template <class T, class R>
+T operator+(T&& l, const Expression<T, R>& r) {
+    accumulate(l, r, false);
+    return std::move(l);
+}
+
+template <class T, class R>
+T operator-(T&& l, const Expression<T, R>& r) {
+    accumulate(l, r, true);
+    return std::move(l);
+}
+
+} /* namespace expression */
+
+} /* namespace BigNumerics */
+
+#endif
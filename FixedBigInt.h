@@ -0,0 +1,498 @@
+#ifndef BIGNUMERICS_FIXEDBIGINT_H
+#define BIGNUMERICS_FIXEDBIGINT_H
+
+#if __cplusplus < 201703L
+#error "FixedBigInt.h needs C++17 for its constexpr arithmetic"
+#endif
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include "BigInteger.h"
+
+namespace BigNumerics {
+
+/*
+ * Unsigned integers of a fixed number of bits, a multiple of 64, for hashes,
+ * identifiers and cryptographic sizes where BigInteger's variable length
+ * costs more than the arithmetic itself. The limbs live in a std::array
+ * inside the object and every operation is constexpr, with loops bounded by
+ * the limb count so that the compiler unrolls them for each width.
+ *
+ * Like the built-in unsigned types, arithmetic wraps modulo 2^Bits and
+ * shifting by Bits or more gives zero. Converting from a negative integer or
+ * BigInteger keeps its value modulo 2^Bits, so -1 has all bits set,
+ * converting back is exact.
+ */
+template <std::size_t Bits>
+class FixedBigInt {
+
+    static_assert(Bits > 0 && Bits % detail::LIMB_BITS == 0,
+                  "FixedBigInt needs a positive multiple of 64 bits");
+
+public:
+    typedef detail::Limb Limb;
+
+    static constexpr std::size_t LIMBS = Bits / detail::LIMB_BITS;
+
+    constexpr FixedBigInt() : limbs{} {}
+
+    // Any built-in integer of at most 64 bits, negative ones sign-extended.
+    template <class T, typename std::enable_if<
+                  std::is_integral<T>::value && sizeof(T) <= sizeof(Limb),
+                  int>::type = 0>
+    constexpr FixedBigInt(T n) : limbs{} {
+        this->limbs[0] = (Limb)n;
+        if constexpr (std::is_signed<T>::value) {
+            for (std::size_t i = 1; i < LIMBS; i++) {
+                this->limbs[i] = n < 0 ? ~(Limb)0 : 0;
+            }
+        }
+    }
+
+    explicit FixedBigInt(const BigInteger& n) : limbs{} {
+        std::size_t size = std::min(n.limbs.size(), LIMBS);
+        for (std::size_t i = 0; i < size; i++) {
+            this->limbs[i] = n.limbs[i];
+        }
+        if (n.limbs.negative()) {
+            *this = -*this;
+        }
+    }
+
+    explicit FixedBigInt(const std::string& n) :
+        FixedBigInt(BigInteger(n)) {}
+
+    BigInteger toBigInteger() const {
+        std::size_t size = significantLimbs(this->limbs);
+        detail::LimbVector limbs(size);
+        for (std::size_t i = 0; i < size; i++) {
+            limbs[i] = this->limbs[i];
+        }
+        return BigInteger(std::move(limbs));
+    }
+
+    std::string toString() const {
+        return toBigInteger().toString();
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const FixedBigInt& n) {
+        return os << n.toString();
+    }
+
+    // Limb i, least significant first.
+    constexpr Limb limb(std::size_t i) const {
+        return this->limbs[i];
+    }
+
+    constexpr void setLimb(std::size_t i, Limb limb) {
+        this->limbs[i] = limb;
+    }
+
+    constexpr explicit operator bool() const {
+        return significantLimbs(this->limbs) != 0;
+    }
+
+    constexpr std::size_t bitLength() const {
+        std::size_t size = significantLimbs(this->limbs);
+        return size == 0 ? 0 : size * detail::LIMB_BITS -
+            (std::size_t)__builtin_clzll(this->limbs[size - 1]);
+    }
+
+    constexpr FixedBigInt& operator+=(const FixedBigInt& rhs) {
+        // Carries from comparisons, which compilers turn into flags more
+        // readily than the high half of a DoubleLimb sum.
+        Limb carry = 0;
+#pragma GCC unroll 32
+        for (std::size_t i = 0; i < LIMBS; i++) {
+            Limb sum = this->limbs[i] + rhs.limbs[i];
+            Limb c = sum < rhs.limbs[i];
+            this->limbs[i] = sum + carry;
+            carry = c | (this->limbs[i] < sum);
+        }
+        return *this;
+    }
+
+    constexpr FixedBigInt& operator-=(const FixedBigInt& rhs) {
+        Limb borrow = 0;
+#pragma GCC unroll 32
+        for (std::size_t i = 0; i < LIMBS; i++) {
+            Limb difference = this->limbs[i] - rhs.limbs[i];
+            Limb b = this->limbs[i] < rhs.limbs[i];
+            this->limbs[i] = difference - borrow;
+            borrow = b | (difference < borrow);
+        }
+        return *this;
+    }
+
+    constexpr FixedBigInt& operator*=(const FixedBigInt& rhs) {
+        *this = multiplyLow(*this, rhs);
+        return *this;
+    }
+
+    constexpr FixedBigInt& operator/=(const FixedBigInt& rhs) {
+        FixedBigInt remainder;
+        divmod(*this, rhs, *this, remainder);
+        return *this;
+    }
+
+    constexpr FixedBigInt& operator%=(const FixedBigInt& rhs) {
+        FixedBigInt quotient;
+        divmod(*this, rhs, quotient, *this);
+        return *this;
+    }
+
+    constexpr FixedBigInt& operator&=(const FixedBigInt& rhs) {
+        for (std::size_t i = 0; i < LIMBS; i++) {
+            this->limbs[i] &= rhs.limbs[i];
+        }
+        return *this;
+    }
+
+    constexpr FixedBigInt& operator|=(const FixedBigInt& rhs) {
+        for (std::size_t i = 0; i < LIMBS; i++) {
+            this->limbs[i] |= rhs.limbs[i];
+        }
+        return *this;
+    }
+
+    constexpr FixedBigInt& operator^=(const FixedBigInt& rhs) {
+        for (std::size_t i = 0; i < LIMBS; i++) {
+            this->limbs[i] ^= rhs.limbs[i];
+        }
+        return *this;
+    }
+
+    constexpr FixedBigInt& operator<<=(std::size_t bits) {
+        std::size_t offset = bits / detail::LIMB_BITS;
+        unsigned s = bits % detail::LIMB_BITS;
+        for (std::size_t i = LIMBS; i > 0; i--) {
+            std::size_t k = i - 1;
+            Limb high = k >= offset ? this->limbs[k - offset] : 0;
+            Limb low = s != 0 && k >= offset + 1 ?
+                this->limbs[k - offset - 1] : 0;
+            this->limbs[k] = s == 0 ? high :
+                high << s | low >> (detail::LIMB_BITS - s);
+        }
+        return *this;
+    }
+
+    constexpr FixedBigInt& operator>>=(std::size_t bits) {
+        std::size_t offset = bits / detail::LIMB_BITS;
+        unsigned s = bits % detail::LIMB_BITS;
+        for (std::size_t k = 0; k < LIMBS; k++) {
+            Limb low = offset < LIMBS - k ? this->limbs[k + offset] : 0;
+            Limb high = s != 0 && offset + 1 < LIMBS - k ?
+                this->limbs[k + offset + 1] : 0;
+            this->limbs[k] = s == 0 ? low :
+                low >> s | high << (detail::LIMB_BITS - s);
+        }
+        return *this;
+    }
+
+    constexpr FixedBigInt& operator++() {
+        return *this += 1;
+    }
+
+    constexpr FixedBigInt& operator--() {
+        return *this -= 1;
+    }
+
+    friend constexpr FixedBigInt operator+(FixedBigInt lhs,
+                                           const FixedBigInt& rhs) {
+        return lhs += rhs;
+    }
+
+    friend constexpr FixedBigInt operator-(FixedBigInt lhs,
+                                           const FixedBigInt& rhs) {
+        return lhs -= rhs;
+    }
+
+    friend constexpr FixedBigInt operator*(const FixedBigInt& lhs,
+                                           const FixedBigInt& rhs) {
+        return multiplyLow(lhs, rhs);
+    }
+
+    friend constexpr FixedBigInt operator/(FixedBigInt lhs,
+                                           const FixedBigInt& rhs) {
+        return lhs /= rhs;
+    }
+
+    friend constexpr FixedBigInt operator%(FixedBigInt lhs,
+                                           const FixedBigInt& rhs) {
+        return lhs %= rhs;
+    }
+
+    friend constexpr FixedBigInt operator&(FixedBigInt lhs,
+                                           const FixedBigInt& rhs) {
+        return lhs &= rhs;
+    }
+
+    friend constexpr FixedBigInt operator|(FixedBigInt lhs,
+                                           const FixedBigInt& rhs) {
+        return lhs |= rhs;
+    }
+
+    friend constexpr FixedBigInt operator^(FixedBigInt lhs,
+                                           const FixedBigInt& rhs) {
+        return lhs ^= rhs;
+    }
+
+    friend constexpr FixedBigInt operator<<(FixedBigInt lhs,
+                                            std::size_t bits) {
+        return lhs <<= bits;
+    }
+
+    friend constexpr FixedBigInt operator>>(FixedBigInt lhs,
+                                            std::size_t bits) {
+        return lhs >>= bits;
+    }
+
+    constexpr FixedBigInt operator-() const {
+        return FixedBigInt() - *this;
+    }
+
+    constexpr FixedBigInt operator~() const {
+        FixedBigInt r;
+        for (std::size_t i = 0; i < LIMBS; i++) {
+            r.limbs[i] = ~this->limbs[i];
+        }
+        return r;
+    }
+
+    friend constexpr bool operator==(const FixedBigInt& l,
+                                     const FixedBigInt& r) {
+        for (std::size_t i = 0; i < LIMBS; i++) {
+            if (l.limbs[i] != r.limbs[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    friend constexpr bool operator!=(const FixedBigInt& l,
+                                     const FixedBigInt& r) {
+        return !operator==(l, r);
+    }
+
+    friend constexpr bool operator<(const FixedBigInt& l,
+                                    const FixedBigInt& r) {
+        for (std::size_t i = LIMBS; i > 0; i--) {
+            if (l.limbs[i - 1] != r.limbs[i - 1]) {
+                return l.limbs[i - 1] < r.limbs[i - 1];
+            }
+        }
+        return false;
+    }
+
+    friend constexpr bool operator>(const FixedBigInt& l,
+                                    const FixedBigInt& r) {
+        return operator<(r, l);
+    }
+
+    friend constexpr bool operator<=(const FixedBigInt& l,
+                                     const FixedBigInt& r) {
+        return !operator>(l, r);
+    }
+
+    friend constexpr bool operator>=(const FixedBigInt& l,
+                                     const FixedBigInt& r) {
+        return !operator<(l, r);
+    }
+
+    // The full 2 Bits product of a and b.
+    friend constexpr FixedBigInt<2 * Bits> multiplyWide(const FixedBigInt& a,
+                                                        const FixedBigInt& b) {
+        FixedBigInt<2 * Bits> r;
+        for (std::size_t j = 0; j < LIMBS; j++) {
+            Limb carry = 0;
+#pragma GCC unroll 32
+            for (std::size_t i = 0; i < LIMBS; i++) {
+                detail::DoubleLimb t = (detail::DoubleLimb)a.limbs[i] *
+                    b.limbs[j] + r.limb(i + j) + carry;
+                r.setLimb(i + j, (Limb)t);
+                carry = (Limb)(t >> detail::LIMB_BITS);
+            }
+            r.setLimb(j + LIMBS, carry);
+        }
+        return r;
+    }
+
+    /*
+     * q = a / b and r = a % b, Algorithm 4.3.1 D on the fixed limbs. q and r
+     * may alias a or b. Dividing by zero throws std::domain_error.
+     */
+    static constexpr void divmod(const FixedBigInt& a, const FixedBigInt& b,
+                                 FixedBigInt& q, FixedBigInt& r) {
+        std::size_t n = significantLimbs(b.limbs);
+        if (n == 0) {
+            throw std::domain_error("FixedBigInt: division by zero");
+        }
+
+        FixedBigInt quotient;
+        FixedBigInt remainder;
+        std::size_t m = significantLimbs(a.limbs);
+
+        if (a < b) {
+            remainder = a;
+        }
+        else if (n == 1) {
+            Limb d = b.limbs[0];
+            Limb k = 0;
+            for (std::size_t j = m; j > 0; j--) {
+                quotient.limbs[j - 1] = divideDoubleLimb(k, a.limbs[j - 1],
+                                                         d, k);
+            }
+            remainder.limbs[0] = k;
+        }
+        else {
+            divideLong(a.limbs, m, b.limbs, n, quotient.limbs,
+                       remainder.limbs);
+        }
+
+        q = quotient;
+        r = remainder;
+    }
+
+private:
+    template <std::size_t>
+    friend class FixedBigInt;
+
+    typedef std::array<Limb, LIMBS> Limbs;
+
+    Limbs limbs;
+
+    /*
+     * (hi 2^64 + lo) / d for hi < d, with the divq instruction of
+     * detail::divideDoubleLimb outside of constant evaluation.
+     */
+    static constexpr Limb divideDoubleLimb(Limb hi, Limb lo, Limb d,
+                                           Limb& remainder) {
+        if (!__builtin_is_constant_evaluated()) {
+            return detail::divideDoubleLimb(hi, lo, d, remainder);
+        }
+
+        detail::DoubleLimb n = (detail::DoubleLimb)hi << detail::LIMB_BITS |
+            lo;
+        remainder = (Limb)(n % d);
+        return (Limb)(n / d);
+    }
+
+    static constexpr std::size_t significantLimbs(const Limbs& a) {
+        std::size_t n = LIMBS;
+        while (n > 0 && a[n - 1] == 0) {
+            n--;
+        }
+        return n;
+    }
+
+    // a b mod 2^Bits, skipping the partial products above the width.
+    static constexpr FixedBigInt multiplyLow(const FixedBigInt& a,
+                                             const FixedBigInt& b) {
+        FixedBigInt r;
+        for (std::size_t j = 0; j < LIMBS; j++) {
+            Limb carry = 0;
+#pragma GCC unroll 32
+            for (std::size_t i = 0; i + j < LIMBS; i++) {
+                detail::DoubleLimb t = (detail::DoubleLimb)a.limbs[i] *
+                    b.limbs[j] + r.limbs[i + j] + carry;
+                r.limbs[i + j] = (Limb)t;
+                carry = (Limb)(t >> detail::LIMB_BITS);
+            }
+        }
+        return r;
+    }
+
+    /*
+     * Algorithm D for an m limb u and an n limb v with u >= v and n >= 2.
+     * q and r start out zero.
+     */
+    static constexpr void divideLong(const Limbs& u, std::size_t m,
+                                     const Limbs& v, std::size_t n,
+                                     Limbs& q, Limbs& r) {
+        // D1, normalize so that the top bit of v is set.
+        unsigned s = (unsigned)__builtin_clzll(v[n - 1]);
+        std::array<Limb, LIMBS + 1> un{};
+        Limbs vn{};
+        for (std::size_t i = n; i > 0; i--) {
+            Limb low = s != 0 && i > 1 ?
+                v[i - 2] >> (detail::LIMB_BITS - s) : 0;
+            vn[i - 1] = v[i - 1] << s | low;
+        }
+        un[m] = s != 0 ? u[m - 1] >> (detail::LIMB_BITS - s) : 0;
+        for (std::size_t i = m; i > 0; i--) {
+            Limb low = s != 0 && i > 1 ?
+                u[i - 2] >> (detail::LIMB_BITS - s) : 0;
+            un[i - 1] = u[i - 1] << s | low;
+        }
+
+        // D2 to D7
+        for (std::size_t j = m - n + 1; j-- > 0;) {
+            // D3, the top limb of u never exceeds the top limb of v.
+            Limb qHat = ~(Limb)0;
+            Limb rHat = 0;
+            bool rHatOverflow = false;
+            if (un[j + n] < vn[n - 1]) {
+                qHat = divideDoubleLimb(un[j + n], un[j + n - 1], vn[n - 1],
+                                        rHat);
+            }
+            else {
+                rHat = un[j + n - 1] + vn[n - 1];
+                rHatOverflow = rHat < vn[n - 1];
+            }
+            while (!rHatOverflow &&
+                   (detail::DoubleLimb)qHat * vn[n - 2] >
+                   ((detail::DoubleLimb)rHat << detail::LIMB_BITS |
+                    un[j + n - 2])) {
+                qHat--;
+                rHat += vn[n - 1];
+                rHatOverflow = rHat < vn[n - 1];
+            }
+
+            Limb q1 = qHat;
+            Limb carry = 0;
+            Limb borrow = 0;
+            for (std::size_t i = 0; i < n; i++) {
+                detail::DoubleLimb p = (detail::DoubleLimb)q1 * vn[i] + carry;
+                carry = (Limb)(p >> detail::LIMB_BITS);
+                Limb difference = un[i + j] - (Limb)p;
+                Limb b = un[i + j] < (Limb)p;
+                un[i + j] = difference - borrow;
+                borrow = b | (difference < borrow);
+            }
+            Limb top = un[j + n] - carry;
+            bool negative = un[j + n] < carry || top < borrow;
+            un[j + n] = top - borrow;
+
+            if (negative) {
+                q1--;
+                Limb c = 0;
+                for (std::size_t i = 0; i < n; i++) {
+                    detail::DoubleLimb t = (detail::DoubleLimb)un[i + j] +
+                        vn[i] + c;
+                    un[i + j] = (Limb)t;
+                    c = (Limb)(t >> detail::LIMB_BITS);
+                }
+                un[j + n] += c;
+            }
+
+            q[j] = q1;
+        }
+
+        // D8, unnormalize the remainder.
+        for (std::size_t i = 0; i < n; i++) {
+            Limb high = s != 0 ? un[i + 1] << (detail::LIMB_BITS - s) : 0;
+            r[i] = un[i] >> s | high;
+        }
+    }
+};
+
+} /* namespace BigNumerics */
+
+#endif
@@ -0,0 +1,458 @@
+#ifndef BIGNUMERICS_PARALLEL_H
+#define BIGNUMERICS_PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+ * <execution> needs TBB at link time with libstdc++ when its headers are
+ * installed, so the std::execution policies are only accepted when
+ * BIGNUMERICS_STD_EXECUTION is defined before including the headers.
+ */
+#if defined(BIGNUMERICS_STD_EXECUTION) && __cplusplus >= 201703L
+#include <execution>
+#define BIGNUMERICS_HAS_EXECUTION
+#endif
+
+namespace BigNumerics {
+
+#ifndef BIGNUMERICS_PARALLEL_GRAIN
+#define BIGNUMERICS_PARALLEL_GRAIN 1000
+#endif
+
+/*
+ * Operands shorter than this many limbs, and transforms shorter than this
+ * many points, are always processed serially by the parallel operations.
+ * Define BIGNUMERICS_PARALLEL_GRAIN before including the headers to change
+ * the default of a ThreadPool.
+ */
+const std::size_t PARALLEL_GRAIN = BIGNUMERICS_PARALLEL_GRAIN;
+static_assert(BIGNUMERICS_PARALLEL_GRAIN >= 1,
+              "the parallel grain must be at least one limb");
+
+class ThreadPool;
+
+namespace detail {
+
+class TaskGroup;
+
+// The pool the current thread works for, null outside parallel operations.
+inline ThreadPool*& currentPool() {
+    static thread_local ThreadPool* pool = nullptr;
+    return pool;
+}
+
+// Index of the current thread's queue in currentPool().
+inline std::size_t& currentQueue() {
+    static thread_local std::size_t queue = 0;
+    return queue;
+}
+
+} /* namespace detail */
+
+/*
+ * Work-stealing thread pool for the parallel operations. Every worker owns a
+ * deque, takes its own tasks newest first and steals the oldest tasks of the
+ * others, which are the largest ones in a recursive multiplication. Threads
+ * outside the pool share one extra deque. A thread waiting for its tasks
+ * runs queued tasks meanwhile and only sleeps once none is left to take.
+ *
+ * threads counts the calling thread, a pool of one thread runs everything
+ * serially on the caller.
+ */
+class ThreadPool {
+
+public:
+    explicit ThreadPool(unsigned threads = std::thread::hardware_concurrency(),
+                        std::size_t grain = PARALLEL_GRAIN) :
+        grainSize{std::max<std::size_t>(grain, 1)},
+        queued{0},
+        stopping{false} {
+        std::size_t workerCount = threads > 1 ? threads - 1 : 0;
+        for (std::size_t i = 0; i <= workerCount; i++) {
+            this->queues.emplace_back(new Queue());
+        }
+        for (std::size_t i = 0; i < workerCount; i++) {
+            this->workers.emplace_back([this, i] { workerLoop(i); });
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(this->sleepMutex);
+            this->stopping = true;
+        }
+        this->wake.notify_all();
+        for (std::size_t i = 0; i < this->workers.size(); i++) {
+            this->workers[i].join();
+        }
+    }
+
+    unsigned threads() const {
+        return (unsigned)this->workers.size() + 1;
+    }
+
+    std::size_t grain() const {
+        return this->grainSize;
+    }
+
+    // The pool used by default, one thread per hardware thread.
+    static ThreadPool& global() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+private:
+    friend class detail::TaskGroup;
+
+    // Callables up to this size are stored in the task itself.
+    static const std::size_t TASK_STORAGE = 64;
+
+    // A forked callable, stored in its TaskGroup until the group joins.
+    struct Task {
+        void (*invoke)(Task&);
+        detail::TaskGroup* group;
+        void* work;
+        alignas(std::max_align_t) unsigned char storage[TASK_STORAGE];
+    };
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task*> tasks;
+    };
+
+    std::size_t outsideQueue() const {
+        return this->workers.size();
+    }
+
+    void submit(Task* task) {
+        std::size_t index = detail::currentPool() == this ?
+            detail::currentQueue() : outsideQueue();
+        Queue& queue = *this->queues[index];
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks.push_back(task);
+        }
+
+        this->queued.fetch_add(1);
+        {
+            std::lock_guard<std::mutex> lock(this->sleepMutex);
+        }
+        this->wake.notify_one();
+    }
+
+    Task* take(std::size_t home) {
+        Queue& own = *this->queues[home];
+        {
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty()) {
+                Task* task = own.tasks.back();
+                own.tasks.pop_back();
+                return task;
+            }
+        }
+
+        std::size_t count = this->queues.size();
+        for (std::size_t i = 1; i < count; i++) {
+            Queue& victim = *this->queues[(home + i) % count];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                Task* task = victim.tasks.front();
+                victim.tasks.pop_front();
+                return task;
+            }
+        }
+        return nullptr;
+    }
+
+    // Runs one queued task from the point of view of queue home.
+    bool runOne(std::size_t home);
+
+    void workerLoop(std::size_t index) {
+        detail::currentPool() = this;
+        detail::currentQueue() = index;
+
+        for (;;) {
+            if (runOne(index)) {
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(this->sleepMutex);
+            this->wake.wait(lock, [this] {
+                return this->stopping || this->queued.load() > 0;
+            });
+            if (this->stopping) {
+                return;
+            }
+        }
+    }
+
+    std::size_t grainSize;
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<std::size_t> queued;
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    bool stopping;
+};
+
+namespace detail {
+
+/*
+ * Fork-join on the pool of the current thread: run() queues a task, wait()
+ * helps with queued tasks until all of them have finished and rethrows the
+ * first exception one of them threw. Outside a pool run() executes the task
+ * right away. The tasks live in the group, the first few of them inline, so
+ * forking small callables does not allocate.
+ */
+class TaskGroup {
+
+public:
+    TaskGroup() : pool{currentPool()}, pending{0}, taskCount{0} {}
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    ~TaskGroup() {
+        join();
+    }
+
+    template <class F>
+    void run(F&& work) {
+        typedef typename std::decay<F>::type Work;
+        if (this->pool == nullptr) {
+            work();
+            return;
+        }
+
+        ThreadPool::Task& task = nextTask();
+        task.invoke = &invoke<Work>;
+        task.group = this;
+        task.work = store<Work>(task, std::forward<F>(work),
+            std::integral_constant<bool,
+                sizeof(Work) <= ThreadPool::TASK_STORAGE &&
+                alignof(Work) <= alignof(std::max_align_t)>());
+
+        this->pending.fetch_add(1);
+        this->pool->submit(&task);
+    }
+
+    void wait() {
+        join();
+        if (this->error) {
+            std::exception_ptr error = this->error;
+            this->error = nullptr;
+            std::rethrow_exception(error);
+        }
+    }
+
+private:
+    friend class BigNumerics::ThreadPool;
+
+    static const std::size_t INLINE_TASKS = 4;
+
+    ThreadPool::Task& nextTask() {
+        if (this->taskCount < INLINE_TASKS) {
+            return this->inlineTasks[this->taskCount++];
+        }
+        this->moreTasks.emplace_back();
+        return this->moreTasks.back();
+    }
+
+    template <class Work, class F>
+    static void* store(ThreadPool::Task& task, F&& work, std::true_type) {
+        return new (task.storage) Work(std::forward<F>(work));
+    }
+
+    template <class Work, class F>
+    static void* store(ThreadPool::Task&, F&& work, std::false_type) {
+        return new Work(std::forward<F>(work));
+    }
+
+    // Runs the callable of task and destroys it, even when it throws.
+    template <class Work>
+    static void invoke(ThreadPool::Task& task) {
+        struct Release {
+            ThreadPool::Task& task;
+
+            ~Release() {
+                Work* work = static_cast<Work*>(this->task.work);
+                if (this->task.work == this->task.storage) {
+                    work->~Work();
+                }
+                else {
+                    delete work;
+                }
+            }
+        } release{task};
+
+        (*static_cast<Work*>(task.work))();
+    }
+
+    void join() {
+        if (this->pool == nullptr) {
+            return;
+        }
+
+        std::size_t home = currentPool() == this->pool ?
+            currentQueue() : this->pool->outsideQueue();
+        while (this->pending.load() != 0 && this->pool->runOne(home)) {
+        }
+
+        /*
+         * Once nothing is left to take, the unfinished tasks run on other
+         * threads, which help with the tasks they fork themselves.
+         */
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->finished.wait(lock, [this] {
+                return this->pending.load() == 0;
+            });
+        }
+        this->taskCount = 0;
+        this->moreTasks.clear();
+    }
+
+    void execute(ThreadPool::Task& task) {
+        try {
+            task.invoke(task);
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            if (!this->error) {
+                this->error = std::current_exception();
+            }
+        }
+
+        /*
+         * join() reads pending under the lock, so the group outlives the
+         * notification.
+         */
+        std::lock_guard<std::mutex> lock(this->mutex);
+        if (this->pending.fetch_sub(1) == 1) {
+            this->finished.notify_one();
+        }
+    }
+
+    ThreadPool* pool;
+    std::atomic<std::size_t> pending;
+    std::mutex mutex;
+    std::condition_variable finished;
+    std::exception_ptr error;
+    std::size_t taskCount;
+    ThreadPool::Task inlineTasks[INLINE_TASKS];
+    std::deque<ThreadPool::Task> moreTasks;
+};
+
+// Whether work on size limbs or points should be split across the pool.
+inline bool forkable(std::size_t size) {
+    ThreadPool* pool = currentPool();
+    return pool != nullptr && pool->threads() > 1 && size >= pool->grain();
+}
+
+/*
+ * f(begin, end) over consecutive chunks of [first, last), in parallel when
+ * the range is forkable().
+ */
+template <class F>
+void parallelFor(std::size_t first, std::size_t last, const F& f) {
+    std::size_t n = last - first;
+    if (!forkable(n)) {
+        f(first, last);
+        return;
+    }
+
+    ThreadPool* pool = currentPool();
+    std::size_t chunk = std::max(pool->grain(), n / (4 * pool->threads()));
+    TaskGroup tasks;
+    for (std::size_t begin = first + chunk; begin < last; begin += chunk) {
+        std::size_t end = std::min(begin + chunk, last);
+        tasks.run([&f, begin, end] { f(begin, end); });
+    }
+    f(first, std::min(first + chunk, last));
+    tasks.wait();
+}
+
+// Makes pool the pool of the current thread for its lifetime.
+class PoolScope {
+
+public:
+    explicit PoolScope(ThreadPool& pool) :
+        previousPool{currentPool()}, previousQueue{currentQueue()} {
+        if (currentPool() != &pool) {
+            currentPool() = &pool;
+            currentQueue() = pool.threads() - 1;
+        }
+    }
+
+    PoolScope(const PoolScope&) = delete;
+    PoolScope& operator=(const PoolScope&) = delete;
+
+    ~PoolScope() {
+        currentPool() = this->previousPool;
+        currentQueue() = this->previousQueue;
+    }
+
+private:
+    ThreadPool* previousPool;
+    std::size_t previousQueue;
+};
+
+} /* namespace detail */
+
+inline bool ThreadPool::runOne(std::size_t home) {
+    Task* task = take(home);
+    if (task == nullptr) {
+        return false;
+    }
+
+    this->queued.fetch_sub(1);
+    task->group->execute(*task);
+    return true;
+}
+
+/*
+ * Selects the parallel overloads of the operations, e.g.
+ * multiply(ParallelPolicy(pool), a, b). The default policy, like
+ * std::execution::par with BIGNUMERICS_STD_EXECUTION, runs on
+ * ThreadPool::global().
+ */
+class ParallelPolicy {
+
+public:
+    ParallelPolicy() : pool{nullptr} {}
+
+    explicit ParallelPolicy(ThreadPool& pool) : pool{&pool} {}
+
+#ifdef BIGNUMERICS_HAS_EXECUTION
+    ParallelPolicy(const std::execution::parallel_policy&) : pool{nullptr} {}
+
+    ParallelPolicy(const std::execution::parallel_unsequenced_policy&) :
+        pool{nullptr} {}
+#endif
+
+    ThreadPool& threadPool() const {
+        return this->pool != nullptr ? *this->pool : ThreadPool::global();
+    }
+
+private:
+    ThreadPool* pool;
+};
+
+} /* namespace BigNumerics */
+
+#endif
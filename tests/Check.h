@@ -0,0 +1,46 @@
+#ifndef BIGNUMERICS_TESTS_CHECK_H
+#define BIGNUMERICS_TESTS_CHECK_H
+
+#include <iostream>
+
+/*
+ * Minimal checks for the test programs: a failed check is reported with its
+ * location and the program exits with status 1 from checkResult().
+ */
+inline int& checkFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+inline void checkFailed(const char* file, int line, const char* condition) {
+    std::cerr << file << ":" << line << ": check failed: " << condition
+              << std::endl;
+    checkFailures()++;
+}
+
+#define CHECK(condition)                                                    \
+    do {                                                                    \
+        if (!(condition)) {                                                 \
+            checkFailed(__FILE__, __LINE__, #condition);                    \
+        }                                                                   \
+    } while (0)
+
+#define CHECK_THROWS(statement, exception)                                  \
+    do {                                                                    \
+        bool thrown = false;                                                \
+        try {                                                               \
+            statement;                                                      \
+        }                                                                   \
+        catch (const exception&) {                                          \
+            thrown = true;                                                  \
+        }                                                                   \
+        if (!thrown) {                                                      \
+            checkFailed(__FILE__, __LINE__, #statement " throws " #exception); \
+        }                                                                   \
+    } while (0)
+
+inline int checkResult() {
+    return checkFailures() == 0 ? 0 : 1;
+}
+
+#endif
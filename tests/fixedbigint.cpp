@@ -0,0 +1,47 @@
+#include "FixedBigInt.h"
+
+#include "Check.h"
+
+using namespace BigNumerics;
+
+/*
+ * Negative integers and BigIntegers convert modulo 2^Bits like the built-in
+ * unsigned types, they used to be zero-extended from 64 bits.
+ */
+static void testSignExtension() {
+    FixedBigInt<256> minusOne = -1;
+    for (std::size_t i = 0; i < FixedBigInt<256>::LIMBS; i++) {
+        CHECK(minusOne.limb(i) == ~(detail::Limb)0);
+    }
+    CHECK(minusOne == ~FixedBigInt<256>());
+    CHECK(FixedBigInt<256>(BigInteger(-1)) == minusOne);
+    CHECK(minusOne + 1 == 0);
+    CHECK(minusOne.toBigInteger() ==
+          BigInteger("115792089237316195423570985008687907853269984665640564"
+                     "039457584007913129639935"));
+
+    CHECK(FixedBigInt<256>(-7) == FixedBigInt<256>(BigInteger(-7)));
+    CHECK(FixedBigInt<256>((short)-1) == minusOne);
+    CHECK(FixedBigInt<256>(-9223372036854775807LL - 1).toBigInteger() ==
+          BigInteger("115792089237316195423570985008687907853269984665640564"
+                     "039448360635876274864128"));
+    CHECK(FixedBigInt<128>(-2) * -3 == 6);
+
+    static_assert(FixedBigInt<256>(-5) + 5 == 0,
+                  "negative constants sign-extend at compile time");
+}
+
+static void testUnsignedConversions() {
+    CHECK(FixedBigInt<256>(5u) == 5);
+    CHECK(FixedBigInt<256>((unsigned char)200) == 200);
+    CHECK(FixedBigInt<256>(~0ULL).toBigInteger() ==
+          BigInteger("18446744073709551615"));
+    CHECK((FixedBigInt<256>(9223372036854775807LL) + 1).toBigInteger() ==
+          BigInteger("9223372036854775808"));
+}
+
+int main() {
+    testSignExtension();
+    testUnsignedConversions();
+    return checkResult();
+}
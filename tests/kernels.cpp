@@ -0,0 +1,398 @@
+#include "BigInteger.h"
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Check.h"
+
+using namespace BigNumerics;
+
+/*
+ * Differential tests of the subquadratic kernels. The operand lengths are
+ * taken around the thresholds the headers were compiled with, so that the
+ * Makefile covers Karatsuba, Toom-Cook, the NTT, Burnikel-Ziegler, Newton
+ * division, half-GCD, REDC and the decimal conversion both at their default
+ * thresholds and with all of them shrunk to a few limbs.
+ *
+ * The reference is arithmetic modulo word-sized primes on the limbs read
+ * back from serialize(), independent of the kernels under test: an identity
+ * such as q b + r = a holds exactly when it holds modulo enough primes, and
+ * a bound on r then makes the quotient and remainder unique.
+ */
+
+namespace {
+
+typedef detail::Limb Limb;
+typedef detail::DoubleLimb DoubleLimb;
+
+const Limb PRIMES[] = {
+    (1ULL << 61) - 1,
+    (1ULL << 62) - 57,
+    (1ULL << 63) - 25,
+    0xFFFFFFFFFFFFFFC5ULL, // 2^64 - 59
+};
+const std::size_t PRIME_COUNT = sizeof(PRIMES) / sizeof(PRIMES[0]);
+
+std::mt19937_64 generator(20261018);
+
+// x modulo every prime, from the limbs of its serialized record.
+struct Residues {
+    Limb r[PRIME_COUNT];
+
+    explicit Residues(const BigInteger& x) {
+        std::vector<unsigned char> record;
+        x.serialize(record);
+        bool negative = (record[1] & detail::SERIAL_NEGATIVE) != 0;
+        std::size_t n = detail::loadLittleEndian(record.data() + 8);
+        const unsigned char* limbs =
+            record.data() + detail::SERIAL_HEADER_SIZE;
+        for (std::size_t k = 0; k < PRIME_COUNT; k++) {
+            Limb p = PRIMES[k];
+            Limb value = 0;
+            for (std::size_t i = n; i-- > 0;) {
+                Limb limb = detail::loadLittleEndian(limbs + 8 * i);
+                value = (Limb)((((DoubleLimb)value << 64) + limb % p) % p);
+            }
+            this->r[k] = negative && value != 0 ? p - value : value;
+        }
+    }
+
+    // The residues of a decimal string, sign included.
+    explicit Residues(const std::string& s) {
+        bool negative = !s.empty() && s[0] == '-';
+        for (std::size_t k = 0; k < PRIME_COUNT; k++) {
+            Limb p = PRIMES[k];
+            Limb value = 0;
+            for (std::size_t i = negative ? 1 : 0; i < s.size(); i++) {
+                value = (Limb)(((DoubleLimb)value * 10 + (Limb)(s[i] - '0')) %
+                               p);
+            }
+            this->r[k] = negative && value != 0 ? p - value : value;
+        }
+    }
+
+    Residues() : r{} {}
+
+    Residues operator+(const Residues& o) const {
+        Residues s;
+        for (std::size_t k = 0; k < PRIME_COUNT; k++) {
+            s.r[k] = (Limb)(((DoubleLimb)this->r[k] + o.r[k]) % PRIMES[k]);
+        }
+        return s;
+    }
+
+    Residues operator*(const Residues& o) const {
+        Residues s;
+        for (std::size_t k = 0; k < PRIME_COUNT; k++) {
+            s.r[k] = (Limb)((DoubleLimb)this->r[k] * o.r[k] % PRIMES[k]);
+        }
+        return s;
+    }
+
+    bool operator==(const Residues& o) const {
+        for (std::size_t k = 0; k < PRIME_COUNT; k++) {
+            if (this->r[k] != o.r[k]) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+/*
+ * A number of n limbs built from its serialized record, mixing random limbs
+ * with runs of all ones and of zeroes that drive carries and borrows across
+ * the kernels.
+ */
+BigInteger randomNumber(std::size_t n, bool negative = false) {
+    std::vector<unsigned char> record(detail::SERIAL_HEADER_SIZE + 8 * n);
+    record[0] = detail::SERIAL_VERSION;
+    record[1] = negative && n > 0 ? detail::SERIAL_NEGATIVE : 0;
+    detail::storeLittleEndian(record.data() + 8, n);
+
+    int pattern = (int)(generator() % 4);
+    for (std::size_t i = 0; i < n; i++) {
+        Limb limb = generator();
+        if (pattern == 1 || (pattern == 3 && generator() % 8 == 0)) {
+            limb = ~(Limb)0;
+        }
+        else if (pattern == 2 && generator() % 2 == 0) {
+            limb = 0;
+        }
+        if (i == n - 1 && limb == 0) {
+            limb = 1;
+        }
+        detail::storeLittleEndian(record.data() + detail::SERIAL_HEADER_SIZE +
+                                  8 * i, limb);
+    }
+    return BigInteger::deserialize(record.data(), record.size());
+}
+
+bool randomSign() {
+    return generator() % 2 == 0;
+}
+
+BigInteger absolute(const BigInteger& x) {
+    return x < BigInteger(0) ? BigInteger(0) - x : x;
+}
+
+/*
+ * Lengths around a threshold t, where a kernel takes over or recurses
+ * for the first time.
+ */
+void addLengthsAround(std::vector<std::size_t>& lengths, std::size_t t) {
+    std::size_t candidates[] = {t - 1, t, t + 1, t + t / 2, 2 * t + 3};
+    for (std::size_t n : candidates) {
+        if (n >= 1) {
+            lengths.push_back(n);
+        }
+    }
+}
+
+// Short lengths are cheap, they get several rounds of fresh operands.
+int roundsFor(std::size_t n) {
+    return n < 100 ? 20 : 1;
+}
+
+std::vector<std::size_t> multiplicationLengths() {
+    std::vector<std::size_t> lengths = {1, 2, 3, 5};
+    addLengthsAround(lengths, detail::KARATSUBA_THRESHOLD);
+    addLengthsAround(lengths, detail::SQR_KARATSUBA_THRESHOLD);
+    addLengthsAround(lengths, detail::TOOM3_THRESHOLD);
+    addLengthsAround(lengths, detail::TOOM4_THRESHOLD);
+    addLengthsAround(lengths, detail::NTT_THRESHOLD);
+    return lengths;
+}
+
+void checkProduct(const BigInteger& a, const BigInteger& b) {
+    BigInteger p = a * b;
+    CHECK(Residues(p) == Residues(a) * Residues(b));
+    CHECK(a * b == b * a);
+}
+
+// Balanced and unbalanced products, squares and powers.
+void testMultiplication() {
+    std::vector<std::size_t> lengths = multiplicationLengths();
+    for (std::size_t an : lengths) {
+        for (int round = 0; round < roundsFor(an); round++) {
+            BigInteger a = randomNumber(an, randomSign());
+            checkProduct(a, randomNumber(an, randomSign()));
+            checkProduct(a, randomNumber(an / 2 + 1, randomSign()));
+            checkProduct(a, randomNumber(an / 3 + 1, randomSign()));
+            checkProduct(a, randomNumber(2 * an + 1, randomSign()));
+
+            BigInteger square = a.square();
+            CHECK(Residues(square) == Residues(a) * Residues(a));
+            CHECK(a * a == square);
+
+            Residues cube = Residues(a) * Residues(a) * Residues(a);
+            CHECK(Residues(pow(a, 3)) == cube);
+        }
+    }
+    checkProduct(randomNumber(5), BigInteger(0));
+}
+
+// Decimal strings both ways, checked against the residues of the digits.
+void testDecimalConversion() {
+    std::vector<std::size_t> lengths = {1, 2, 3};
+    addLengthsAround(lengths, detail::DECIMAL_CONVERSION_THRESHOLD);
+    addLengthsAround(lengths, 4 * detail::DECIMAL_CONVERSION_THRESHOLD);
+    for (std::size_t n : lengths) {
+        BigInteger x = randomNumber(n, randomSign());
+        std::string s = x.toString();
+        CHECK(Residues(s) == Residues(x));
+        CHECK(BigInteger(s) == x);
+
+        std::string digits = randomSign() ? "-" : "";
+        digits += (char)('1' + generator() % 9);
+        for (std::size_t i = 1; i < 19 * n; i++) {
+            digits += (char)('0' + generator() % 10);
+        }
+        BigInteger parsed(digits);
+        CHECK(Residues(parsed) == Residues(digits));
+        CHECK(parsed.toString() == digits);
+    }
+}
+
+/*
+ * q and r of a truncated division: q b + r = a with |r| < |b| and r of the
+ * sign of a, which leaves a single pair.
+ */
+void checkDivision(const BigInteger& a, const BigInteger& b) {
+    BigInteger q;
+    BigInteger r;
+    BigInteger::divmod(a, b, q, r);
+    CHECK(Residues(q) * Residues(b) + Residues(r) == Residues(a));
+    CHECK(absolute(r) < absolute(b));
+    CHECK(r == BigInteger(0) || (r < BigInteger(0)) == (a < BigInteger(0)));
+    CHECK(a / b == q);
+    CHECK(a % b == r);
+}
+
+void testDivision() {
+    std::vector<std::size_t> lengths = {1, 2, 3};
+    addLengthsAround(lengths, detail::BZ_THRESHOLD);
+    addLengthsAround(lengths, detail::NEWTON_DIVISION_THRESHOLD);
+    for (std::size_t n : lengths) {
+        for (int round = 0; round < roundsFor(n); round++) {
+            BigInteger b = randomNumber(n, randomSign());
+            // Newton division takes quotients of at least twice the divisor.
+            std::size_t dividendLengths[] = {n, n + 1, n + n / 2, 2 * n + 1,
+                                             3 * n + 2};
+            for (std::size_t m : dividendLengths) {
+                checkDivision(randomNumber(m, randomSign()), b);
+            }
+
+            // Quotients right next to a multiple of b, where the quotient
+            // digit estimates need their corrections.
+            BigInteger multiple = randomNumber(2 * n + 1) * b;
+            checkDivision(multiple, b);
+            checkDivision(multiple + absolute(b) - BigInteger(1), b);
+            checkDivision(multiple - BigInteger(1), b);
+        }
+    }
+    checkDivision(BigInteger(0), randomNumber(3));
+    CHECK_THROWS(checkDivision(randomNumber(3), BigInteger(0)),
+                 std::domain_error);
+}
+
+// gcd is the only common divisor that is also a combination s a + t b.
+void checkGcd(const BigInteger& a, const BigInteger& b) {
+    BigInteger g = gcd(a, b);
+    CHECK(g >= BigInteger(0));
+    if (g != BigInteger(0)) {
+        CHECK(a % g == BigInteger(0));
+        CHECK(b % g == BigInteger(0));
+    }
+
+    BigInteger s;
+    BigInteger t;
+    CHECK(xgcd(a, b, s, t) == g);
+    CHECK(Residues(s) * Residues(a) + Residues(t) * Residues(b) ==
+          Residues(g));
+}
+
+void testGcd() {
+    std::vector<std::size_t> lengths = {1, 2, 3};
+    addLengthsAround(lengths, detail::HGCD_THRESHOLD);
+    for (std::size_t n : lengths) {
+        for (int round = 0; round < roundsFor(n); round++) {
+            BigInteger a = randomNumber(n, randomSign());
+            checkGcd(a, randomNumber(n, randomSign()));
+            checkGcd(a, randomNumber(n / 2 + 1, randomSign()));
+
+            // A common factor of about a third of the length.
+            BigInteger factor = randomNumber(n / 3 + 1);
+            checkGcd(a * factor, randomNumber(n, randomSign()) * factor);
+            checkGcd(a, a * factor);
+
+            BigInteger m = randomNumber(n);
+            if (m == BigInteger(1)) {
+                continue;
+            }
+            if (gcd(a, m) == BigInteger(1)) {
+                BigInteger inverse = modinv(a, m);
+                CHECK(inverse >= BigInteger(0) && inverse < m);
+                BigInteger one = a * inverse % m;
+                CHECK(one == BigInteger(1) || one == BigInteger(1) - m);
+            }
+            else {
+                CHECK_THROWS(modinv(a, m), std::domain_error);
+            }
+        }
+    }
+    checkGcd(BigInteger(0), randomNumber(3, true));
+}
+
+// base^exponent mod modulus by binary exponentiation over * and %.
+BigInteger powmodReference(const BigInteger& base, const BigInteger& exponent,
+                           const BigInteger& modulus) {
+    BigInteger b = base % modulus;
+    if (b < BigInteger(0)) {
+        b += modulus;
+    }
+    BigInteger result = BigInteger(1) % modulus;
+    std::string bits;
+    for (BigInteger e = exponent; e != BigInteger(0); e /= BigInteger(2)) {
+        bits += e % BigInteger(2) == BigInteger(0) ? '0' : '1';
+    }
+    for (std::size_t i = bits.size(); i-- > 0;) {
+        result = result * result % modulus;
+        if (bits[i] == '1') {
+            result = result * b % modulus;
+        }
+    }
+    return result;
+}
+
+// Montgomery for odd moduli, Barrett for even ones.
+void testPowmod() {
+    std::vector<std::size_t> lengths = {1, 2, 3};
+    addLengthsAround(lengths, detail::REDC_THRESHOLD);
+    for (std::size_t n : lengths) {
+        for (int round = 0; round < roundsFor(n) / 4 + 1; round++) {
+            BigInteger modulus = randomNumber(n);
+            if (modulus == BigInteger(1)) {
+                continue;
+            }
+            BigInteger base = randomNumber(2 * n, randomSign());
+            BigInteger exponent = randomNumber(1 + round % 2);
+            BigInteger expected = powmodReference(base, exponent, modulus);
+            CHECK(powmod(base, exponent, modulus) == expected);
+
+            if (modulus % BigInteger(2) != BigInteger(0)) {
+                MontgomeryContext context(modulus);
+                CHECK(context.powmod(base, exponent) == expected);
+            }
+
+            BigInteger odd = modulus * BigInteger(2) + BigInteger(1);
+            CHECK(powmod(base, exponent, odd) ==
+                  powmodReference(base, exponent, odd));
+            BigInteger even = modulus * BigInteger(2);
+            CHECK(powmod(base, exponent, even) ==
+                  powmodReference(base, exponent, even));
+        }
+    }
+}
+
+// s = iroot(x, k) is the largest s with s^k <= x.
+void checkRoot(const BigInteger& x, unsigned k) {
+    BigInteger s = k == 2 ? x.isqrt() : x.iroot(k);
+    CHECK(s >= BigInteger(0));
+    CHECK(pow(s, k) <= x);
+    CHECK(x < pow(s + BigInteger(1), k));
+}
+
+void testRoots() {
+    std::vector<std::size_t> lengths = multiplicationLengths();
+    addLengthsAround(lengths, detail::BZ_THRESHOLD);
+    for (std::size_t n : lengths) {
+        BigInteger x = randomNumber(n);
+        checkRoot(x, 2);
+        checkRoot(x, 3);
+        checkRoot(x, 7);
+
+        BigInteger root = randomNumber(n / 2 + 1);
+        BigInteger square = root * root;
+        CHECK(square.isqrt() == root);
+        CHECK((square - BigInteger(1)).isqrt() == root - BigInteger(1));
+        CHECK(pow(root, 3).iroot(3) == root);
+        CHECK((BigInteger(0) - pow(root, 3)).iroot(3) ==
+              BigInteger(0) - root);
+    }
+    CHECK_THROWS(BigInteger(-4).isqrt(), std::domain_error);
+}
+
+} /* namespace */
+
+int main() {
+    testMultiplication();
+    testDecimalConversion();
+    testDivision();
+    testGcd();
+    testPowmod();
+    testRoots();
+    return checkResult();
+}
@@ -0,0 +1,57 @@
+#include "BigInteger.h"
+
+#include "Check.h"
+
+using namespace BigNumerics;
+
+/*
+ * MontgomeryContext works in fixed buffers of twice the modulus length,
+ * operands outside [0, m) used to overflow them or lose their sign.
+ */
+static void testRepresentationBounds() {
+    MontgomeryContext context(BigInteger(7));
+    BigInteger threeLimbs(
+        "123456789012345678901234567890123456789012345678901234");
+
+    CHECK_THROWS(context.fromMontgomery(threeLimbs), std::invalid_argument);
+    CHECK_THROWS(context.multiply(threeLimbs, threeLimbs),
+                 std::invalid_argument);
+    CHECK_THROWS(context.multiply(BigInteger(1), threeLimbs),
+                 std::invalid_argument);
+    CHECK_THROWS(context.square(threeLimbs), std::invalid_argument);
+    CHECK_THROWS(context.multiply(BigInteger(-1), BigInteger(1)),
+                 std::invalid_argument);
+    CHECK_THROWS(context.square(BigInteger(7)), std::invalid_argument);
+
+    // toMontgomery reduces any value first.
+    BigInteger a = context.toMontgomery(threeLimbs);
+    BigInteger b = context.toMontgomery(BigInteger(-3));
+    BigInteger expected = (threeLimbs * BigInteger(-3)) % BigInteger(7);
+    if (expected < BigInteger(0)) {
+        expected += BigInteger(7);
+    }
+    CHECK(context.fromMontgomery(context.multiply(a, b)) == expected);
+    CHECK(context.fromMontgomery(context.square(BigInteger(0))) ==
+          BigInteger(0));
+}
+
+static void testPowmod() {
+    BigInteger modulus("1000000000000000000000000000000000000000000000000000"
+                       "000000000000000000000007");
+    BigInteger base("123456789012345678901234567890123456789012345678901234");
+    MontgomeryContext context(modulus);
+
+    CHECK(context.fromMontgomery(context.toMontgomery(base)) == base);
+    BigInteger expected(1);
+    for (int i = 0; i < 65; i++) {
+        expected = expected * base % modulus;
+    }
+    CHECK(context.powmod(base, BigInteger(65)) == expected);
+    CHECK(powmod(base, BigInteger(65), modulus) == expected);
+}
+
+int main() {
+    testRepresentationBounds();
+    testPowmod();
+    return checkResult();
+}